@@ -37,6 +37,10 @@
 
 #pragma once
 
+#include "Kinect2Frame.h"
+#include "Kinect2FramePool.h"
+#include "Kinect2Source.h"
+#include "Kinect2TripleBuffer.h"
 #include "KCBv2Lib.h"
 #include "Kinect.Face.h"
 #include "cinder/Exception.h"
@@ -45,8 +49,10 @@
 #include "cinder/Surface.h"
 #include "cinder/TriMesh.h"
 #include <atomic>
+#include <condition_variable>
 #include <functional>
 #include <map>
+#include <mutex>
 #include <thread>
 #include "ole2.h"
 
@@ -61,10 +67,6 @@ namespace Kinect2 {
 
 class Device;
 
-ci::Channel8uRef									channel16To8( const ci::Channel16uRef& channel, uint8_t bytes = 4 );
-ci::Surface8uRef									colorizeBodyIndex( const ci::Channel8uRef& bodyIndexChannel );
-
-ci::Color8u											getBodyColor( size_t index );
 size_t												getDeviceCount();
 std::map<size_t, std::string>						getDeviceMap();
 
@@ -161,127 +163,10 @@ protected:
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 
-class Body
-{
-public:
-
-	//////////////////////////////////////////////////////////////////////////////////////////////
-
-	class Hand
-	{
-	public:
-		Hand();
-
-		TrackingConfidence								getConfidence() const;
-		HandState										getState() const;
-	protected:
-		TrackingConfidence								mConfidence;
-		HandState										mState;
-
-		friend class									Device;
-	};
-	
-	//////////////////////////////////////////////////////////////////////////////////////////////
-
-	class Joint
-	{
-	public:
-		Joint();
-		
-		uint64_t										getId() const;
-		const ci::quat&									getOrientation() const;
-		JointType										getParentJoint() const;
-		const ci::vec3&									getPosition() const;
-		TrackingState									getTrackingState() const;
-	protected:
-		Joint( const ci::vec3& position, const ci::quat& orientation, 
-			TrackingState trackingState, JointType parentJoint );
-		
-		ci::quat										mOrientation;
-		JointType										mParentJoint;
-		ci::vec3										mPosition;
-		TrackingState									mTrackingState;
-
-		friend class									Device;
-	};
-
-	//////////////////////////////////////////////////////////////////////////////////////////////
-
-	Body();
-
-	float												calcConfidence( bool weighted = false ) const;
-
-	const std::map<Activity, DetectionResult>&			getActivities() const;
-	const std::map<Appearance, DetectionResult>&		getAppearances() const;
-	const std::map<Expression, DetectionResult>&		getExpressions() const;
-	const Hand&											getHandLeft() const;
-	const Hand&											getHandRight() const;
-	uint64_t											getId() const;
-	uint8_t												getIndex() const;
-	const std::map<JointType, Body::Joint>&				getJointMap() const;
-	const ci::vec2&										getLean() const;
-	TrackingState										getLeanTrackingState() const;
-	DetectionResult										isEngaged() const;
-	bool												isRestricted() const;
-	bool												isTracked() const;
-protected:
-	std::map<Activity, DetectionResult>					mActivities;
-	std::map<Appearance, DetectionResult>				mAppearances;
-	DetectionResult										mEngaged;
-	std::map<Expression, DetectionResult>				mExpressions;
-	Hand												mHands[ 2 ];
-	uint64_t											mId;
-	uint8_t												mIndex;
-	std::map<JointType, Body::Joint>					mJointMap;
-	ci::vec2											mLean;
-	TrackingState										mLeanTrackingState;
-	bool												mRestricted;
-	bool												mTracked;
-
-	friend class										Device;
-};
-
-//////////////////////////////////////////////////////////////////////////////////////////////
-
-class Frame
-{
-public:
-	Frame();
-
-	long long											getTimeStamp() const;
-protected:
-	long long											mTimeStamp;
-
-	friend class										Device;
-};
-
-//////////////////////////////////////////////////////////////////////////////////////////////
-
-class CameraFrame
-{
-public:
-	CameraFrame();
-
-	float												getFovDiagonal() const;
-	float												getFovHorizontal() const;
-	float												getFovVertical() const;
-	const ci::ivec2&									getSize() const;
-protected:
-	float												mFovDiagonal;
-	float												mFovHorizontal;
-	float												mFovVertical;
-	ci::ivec2											mSize;
-
-	friend class										Device;
-};
-
-//////////////////////////////////////////////////////////////////////////////////////////////
-
 class AudioFrame : public Frame
 {
 public:
 	AudioFrame();
-	~AudioFrame();
 
 	float												getBeamAngle() const;
 	float												getBeamAngleConfidence() const;
@@ -291,7 +176,7 @@ public:
 protected:
 	float												mBeamAngle;
 	float												mBeamAngleConfidence;
-	uint8_t*											mBuffer;
+	std::shared_ptr<uint8_t>							mBuffer;
 	unsigned long										mBufferSize;
 	WAVEFORMATEX										mFormat;
 	
@@ -300,67 +185,6 @@ protected:
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 
-class BodyFrame : public Frame
-{
-public:
-	BodyFrame();
-
-	const std::vector<Body>&							getBodies() const;
-protected:
-	std::vector<Body>									mBodies;
-
-	friend class										Device;
-};
-
-//////////////////////////////////////////////////////////////////////////////////////////////
-
-template<typename T>
-class ChannelFrameT : public Frame
-{
-public:
-	ChannelFrameT();
-
-	const std::shared_ptr<ci::ChannelT<T> >&			getChannel() const;
-protected:
-	std::shared_ptr<ci::ChannelT<T> >					mChannel;
-
-	friend class										Device;
-};
-
-typedef ChannelFrameT<uint8_t>							ChannelFrame8u;
-typedef ChannelFrameT<uint16_t>							ChannelFrame16u;
-
-//////////////////////////////////////////////////////////////////////////////////////////////
-
-class ColorFrame : public CameraFrame, public Frame
-{
-public:
-	ColorFrame();
-
-	const ci::Surface8uRef&								getSurface() const;
-protected:
-	ci::Surface8uRef									mSurface;
-
-	friend class										Device;
-};
-
-//////////////////////////////////////////////////////////////////////////////////////////////
-
-class DepthFrame : public CameraFrame, public ChannelFrame16u
-{
-public:
-	DepthFrame();
-protected:
-	friend class										Device;
-};
-
-//////////////////////////////////////////////////////////////////////////////////////////////
-
-typedef ChannelFrame8u									BodyIndexFrame;
-typedef ChannelFrame16u									InfraredFrame;
-
-//////////////////////////////////////////////////////////////////////////////////////////////
-
 class Face2dFrame : public Frame
 {
 public:
@@ -391,36 +215,44 @@ protected:
 
 typedef std::shared_ptr<Device>	DeviceRef;
 
-class Device
+class Device : public Source
 {
 protected:
 
 	//////////////////////////////////////////////////////////////////////////////////////////////
 	
+	//! Capture thread for one stream. The thread sleeps on a condition
+	//! variable while its event handler is disconnected and publishes
+	//! frames through a TripleBuffer owned by the Device.
 	class Process
 	{
 	public:
 		Process();
 		~Process();
-		Process(const Process &other) = default;
-		Process &operator=( const Process &rhs )
-		{
-			mThreadCallback = rhs.mThreadCallback;
-			mNewData.store( rhs.mNewData );
-			mRunning.store( rhs.mRunning );
-			mThread = rhs.mThread;
-
-			return *this;
-		}
 
 		void											start();
 		void											stop();
+
+		void											enable( bool enable = true );
+		//! Waits out the poll interval unless a frame was just produced, then
+		//! blocks while the stream is disabled. Returns false when the thread should exit.
+		bool											wait();
+		//! Counts a frame written to the stream's TripleBuffer.
+		void											produced( bool dropped );
 	protected:
 		std::function<void ()>							mThreadCallback;
 
-		std::atomic_bool								mNewData;
+		std::condition_variable							mCondition;
+		std::atomic_bool								mEnabled;
+		bool											mFrameProduced;
+		std::mutex										mMutex;
 		std::atomic_bool								mRunning;
 		std::shared_ptr<std::thread>					mThread;
+		long long										mTimeStamp;
+
+		std::atomic<uint64_t>							mNumFramesDelivered;
+		std::atomic<uint64_t>							mNumFramesDropped;
+		std::atomic<uint64_t>							mNumFramesProduced;
 
 		friend class									Device;
 	};
@@ -428,11 +260,64 @@ protected:
 	//////////////////////////////////////////////////////////////////////////////////////////////
 
 public:
+	enum : size_t
+	{
+		FrameType_Audio,
+		FrameType_Body, 
+		FrameType_BodyIndex, 
+		FrameType_Color, 
+		FrameType_Depth, 
+		FrameType_Face2d, 
+		FrameType_Face3d, 
+		FrameType_Infrared, 
+		FrameType_InfraredLongExposure,
+		FrameType_Count
+	} typedef FrameType;
+
+	//! Body data the body thread queries from the sensor. Anything not
+	//! requested is neither fetched nor written into the BodyFrame.
+	enum : uint32_t
+	{
+		BodyFeature_None				= 0,
+		BodyFeature_Activities			= 1 << 0,
+		BodyFeature_Appearances			= 1 << 1,
+		BodyFeature_Expressions			= 1 << 2,
+		BodyFeature_Hands				= 1 << 3,
+		BodyFeature_Joints				= 1 << 4,
+		BodyFeature_JointOrientations	= 1 << 5,
+		BodyFeature_Lean				= 1 << 6,
+		BodyFeature_All					= ( 1 << 7 ) - 1
+	} typedef BodyFeature;
+
+	//! Joint mask with every JointType set.
+	static const uint32_t								kJointMaskAll = ( 1u << JointType_Count ) - 1u;
+
+	//! Frame counters for one stream. Dropped frames were replaced by a
+	//! newer frame before the main thread picked them up. Streams with
+	//! image data also report their buffer pool occupancy.
+	class StreamStats
+	{
+	public:
+		StreamStats();
+
+		uint64_t										getNumFramesDelivered() const;
+		uint64_t										getNumFramesDropped() const;
+		uint64_t										getNumFramesProduced() const;
+		const FramePoolStats&							getPoolStats() const;
+	protected:
+		uint64_t										mNumFramesDelivered;
+		uint64_t										mNumFramesDropped;
+		uint64_t										mNumFramesProduced;
+		FramePoolStats									mPoolStats;
+
+		friend class									Device;
+	};
+
 	static DeviceRef									create();
-	~Device();
+	~Device() override;
 	
-	void												start();
-	void												stop();
+	void												start() override;
+	void												stop() override;
 
 	void												enableFaceMesh( bool enable = true );
 	void												enableHandTracking( bool enable = true );
@@ -441,6 +326,13 @@ public:
 	bool												isHandTrackingEnabled() const;
 	bool												isJointTrackingEnabled() const;
 
+	//! Selects the BodyFeature bits and, with BodyFeature_Joints, the
+	//! joints (bit per JointType) the body thread captures. Takes effect
+	//! on the next body frame.
+	void												setBodyFeatures( uint32_t features, uint32_t jointMask = kJointMaskAll );
+	uint32_t											getBodyFeatures() const;
+	uint32_t											getBodyJointMask() const;
+
 	template<typename T, typename Y>
 	inline void											connectAudioEventHandler( T eventHandler, Y* obj )
 	{
@@ -496,10 +388,10 @@ public:
 	}
 
 	void												connectAudioEventHandler( const std::function<void ( const AudioFrame& )>& eventHandler );
-	void												connectBodyEventHandler( const std::function<void ( const BodyFrame& )>& eventHandler );
-	void												connectBodyIndexEventHandler( const std::function<void ( const BodyIndexFrame& )>& eventHandler );
+	void												connectBodyEventHandler( const std::function<void ( const BodyFrame& )>& eventHandler ) override;
+	void												connectBodyIndexEventHandler( const std::function<void ( const BodyIndexFrame& )>& eventHandler ) override;
 	void												connectColorEventHandler( const std::function<void ( const ColorFrame& )>& eventHandler );
-	void												connectDepthEventHandler( const std::function<void ( const DepthFrame& )>& eventHandler );
+	void												connectDepthEventHandler( const std::function<void ( const DepthFrame& )>& eventHandler ) override;
 	void												connectFace2dEventHandler( const std::function<void ( const Face2dFrame& )>& eventHandler );
 	void												connectFace3dEventHandler( const std::function<void ( const Face3dFrame& )>& eventHandler );
 	void												connectInfraredEventHandler( const std::function<void ( const InfraredFrame& )>& eventHandler );
@@ -527,7 +419,7 @@ public:
 
 	ci::ivec2											mapCameraToColor( const ci::vec3& v ) const;
 	std::vector<ci::ivec2>								mapCameraToColor( const std::vector<ci::vec3>& v ) const;
-	ci::ivec2											mapCameraToDepth( const ci::vec3& v ) const;
+	ci::ivec2											mapCameraToDepth( const ci::vec3& v ) const override;
 	std::vector<ci::ivec2>								mapCameraToDepth( const std::vector<ci::vec3>& v ) const;
 	ci::vec3											mapDepthToCamera( const ci::ivec2& v, const ci::Channel16uRef& depth ) const;
 	std::vector<ci::vec3>								mapDepthToCamera( const std::vector<ci::ivec2>& v, const ci::Channel16uRef& depth ) const;
@@ -536,20 +428,9 @@ public:
 	ci::ivec2											mapDepthToColor( const ci::ivec2& v, const ci::Channel16uRef& depth ) const;
 	std::vector<ci::ivec2>								mapDepthToColor( const std::vector<ci::ivec2>& v, const ci::Channel16uRef& depth ) const;
 	std::vector<ci::ivec2>								mapDepthToColor( const ci::Channel16uRef& depth ) const;
+
+	StreamStats											getStreamStats( FrameType frameType ) const;
 protected:
-	enum : size_t
-	{
-		FrameType_Audio,
-		FrameType_Body, 
-		FrameType_BodyIndex, 
-		FrameType_Color, 
-		FrameType_Depth, 
-		FrameType_Face2d, 
-		FrameType_Face3d, 
-		FrameType_Infrared, 
-		FrameType_InfraredLongExposure
-	} typedef FrameType;
-	
 	Device();
 
 	virtual void										update();
@@ -558,7 +439,7 @@ protected:
 	KCBHANDLE											mKinect;
 	IKinectSensor*										mSensor;
 
-	std::map<FrameType, Process>						mProcesses;
+	Process												mProcesses[ FrameType_Count ];
 	
 	std::function<void ( const AudioFrame& )>			mEventHandlerAudio;
 	std::function<void ( const BodyFrame& )>			mEventHandlerBody;
@@ -570,19 +451,25 @@ protected:
 	std::function<void ( const InfraredFrame& )>		mEventHandlerInfrared;
 	std::function<void ( const InfraredFrame& )>		mEventHandlerInfraredLongExposure;
 
-	AudioFrame											mFrameAudio;
-	BodyFrame											mFrameBody;
-	BodyIndexFrame										mFrameBodyIndex;
-	ColorFrame											mFrameColor;
-	DepthFrame											mFrameDepth;
-	Face2dFrame											mFrameFace2d;
-	Face3dFrame											mFrameFace3d;
-	InfraredFrame										mFrameInfrared;
-	InfraredFrame										mFrameInfraredLongExposure;
-
+	TripleBuffer<AudioFrame>							mFrameAudio;
+	TripleBuffer<BodyFrame>								mFrameBody;
+	TripleBuffer<BodyIndexFrame>						mFrameBodyIndex;
+	TripleBuffer<ColorFrame>							mFrameColor;
+	TripleBuffer<DepthFrame>							mFrameDepth;
+	TripleBuffer<Face2dFrame>							mFrameFace2d;
+	TripleBuffer<Face3dFrame>							mFrameFace3d;
+	TripleBuffer<InfraredFrame>							mFrameInfrared;
+	TripleBuffer<InfraredFrame>							mFrameInfraredLongExposure;
+
+	FramePool<ci::Channel8u>							mPoolBodyIndex;
+	FramePool<ci::Surface8u>							mPoolColor;
+	FramePool<ci::Channel16u>							mPoolDepth;
+	FramePool<ci::Channel16u>							mPoolInfrared;
+	FramePool<ci::Channel16u>							mPoolInfraredLongExposure;
+
+	std::atomic<uint32_t>								mBodyFeatures;
+	std::atomic<uint32_t>								mBodyJointMask;
 	bool												mEnabledFaceMesh;
-	bool												mEnabledHandTracking;
-	bool												mEnabledJointTracking;
 
 	static uint32_t										sFaceModelIndexCount;
 	static uint32_t										sFaceModelVertexCount;
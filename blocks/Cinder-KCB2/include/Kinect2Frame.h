@@ -0,0 +1,354 @@
+/*
+* 
+* Copyright (c) 2015, Wieden+Kennedy
+* Stephen Schieberl
+* All rights reserved.
+* 
+* Redistribution and use in source and binary forms, with or 
+* without modification, are permitted provided that the following 
+* conditions are met:
+* 
+* Redistributions of source code must retain the above copyright 
+* notice, this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright 
+* notice, this list of conditions and the following disclaimer in 
+* the documentation and/or other materials provided with the 
+* distribution.
+* 
+* Neither the name of the Ban the Rewind nor the names of its 
+* contributors may be used to endorse or promote products 
+* derived from this software without specific prior written 
+* permission.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS 
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE 
+* COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, 
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+* STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF 
+* ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+*/
+
+#pragma once
+
+#include "Kinect2Types.h"
+#include "cinder/Channel.h"
+#include "cinder/Quaternion.h"
+#include "cinder/Surface.h"
+#include <array>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+namespace Kinect2 {
+
+class Device;
+class RecordingReader;
+class Replay;
+
+ci::Channel8uRef									channel16To8( const ci::Channel16uRef& channel, uint8_t bytes = 4 );
+ci::Surface8uRef									colorizeBodyIndex( const ci::Channel8uRef& bodyIndexChannel );
+//! As above, writing into caller-owned memory (a mapped pixel buffer, say) 
+//! whose rows are \a dstRowBytes apart. \a dst holds 1 or 4 bytes per pixel.
+void												channel16To8( const ci::Channel16u& channel, uint8_t* dst, size_t dstRowBytes, uint8_t bytes = 4 );
+void												colorizeBodyIndex( const ci::Channel8u& bodyIndexChannel, uint8_t* dst, size_t dstRowBytes );
+
+ci::Color8u											getBodyColor( size_t index );
+
+//! Parent of each joint in the skeleton hierarchy. SpineBase is its own parent.
+constexpr JointType									kJointParents[ JointType_Count ] = {
+	JointType_SpineBase,		// SpineBase
+	JointType_SpineBase,		// SpineMid
+	JointType_SpineShoulder,	// Neck
+	JointType_Neck,				// Head
+	JointType_SpineShoulder,	// ShoulderLeft
+	JointType_ShoulderLeft,		// ElbowLeft
+	JointType_ElbowLeft,		// WristLeft
+	JointType_WristLeft,		// HandLeft
+	JointType_SpineShoulder,	// ShoulderRight
+	JointType_ShoulderRight,	// ElbowRight
+	JointType_ElbowRight,		// WristRight
+	JointType_WristRight,		// HandRight
+	JointType_SpineBase,		// HipLeft
+	JointType_HipLeft,			// KneeLeft
+	JointType_KneeLeft,			// AnkleLeft
+	JointType_AnkleLeft,		// FootLeft
+	JointType_SpineBase,		// HipRight
+	JointType_HipRight,			// KneeRight
+	JointType_KneeRight,		// AnkleRight
+	JointType_AnkleRight,		// FootRight
+	JointType_SpineMid,			// SpineShoulder
+	JointType_HandLeft,			// HandTipLeft
+	JointType_HandLeft,			// ThumbLeft
+	JointType_HandRight,		// HandTipRight
+	JointType_HandRight			// ThumbRight
+};
+
+constexpr JointType									getParentJoint( JointType joint )
+{
+	return kJointParents[ joint ];
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+
+class Body
+{
+public:
+
+	//////////////////////////////////////////////////////////////////////////////////////////////
+
+	class Hand
+	{
+	public:
+		Hand();
+
+		TrackingConfidence								getConfidence() const;
+		HandState										getState() const;
+	protected:
+		TrackingConfidence								mConfidence;
+		HandState										mState;
+
+		friend class									Device;
+		friend class									RecordingReader;
+	};
+	
+	//////////////////////////////////////////////////////////////////////////////////////////////
+
+	//! Copy of one joint, built from the body's joint arrays.
+	class Joint
+	{
+	public:
+		Joint();
+		
+		const ci::quat&									getOrientation() const;
+		JointType										getParentJoint() const;
+		const ci::vec3&									getPosition() const;
+		TrackingState									getTrackingState() const;
+	protected:
+		Joint( const ci::vec3& position, const ci::quat& orientation, 
+			TrackingState trackingState, JointType parentJoint );
+		
+		ci::quat										mOrientation;
+		JointType										mParentJoint;
+		ci::vec3										mPosition;
+		TrackingState									mTrackingState;
+
+		friend class									Body;
+	};
+
+	//////////////////////////////////////////////////////////////////////////////////////////////
+
+	//! Read-only view of a body's joints with the lookup and iteration
+	//! interface of the std::map that used to hold them. Joints are
+	//! returned by value.
+	class JointMap
+	{
+	public:
+		typedef std::pair<JointType, Joint>				value_type;
+
+		class const_iterator
+		{
+		public:
+			typedef std::forward_iterator_tag			iterator_category;
+			typedef std::pair<JointType, Joint>			value_type;
+			typedef std::ptrdiff_t						difference_type;
+			typedef const value_type*					pointer;
+			typedef value_type							reference;
+
+			const_iterator( const Body* body, uint32_t index );
+
+			value_type									operator*() const;
+			const_iterator&								operator++();
+			bool										operator==( const const_iterator& rhs ) const;
+			bool										operator!=( const const_iterator& rhs ) const;
+		protected:
+			const Body*									mBody;
+			uint32_t									mIndex;
+		};
+
+		JointMap( const Body* body );
+
+		Joint											at( JointType jointType ) const;
+		const_iterator									begin() const;
+		size_t											count( JointType jointType ) const;
+		bool											empty() const;
+		const_iterator									end() const;
+		const_iterator									find( JointType jointType ) const;
+		size_t											size() const;
+	protected:
+		const Body*										mBody;
+	};
+
+	//////////////////////////////////////////////////////////////////////////////////////////////
+
+	typedef std::array<DetectionResult, Activity_Count>		ActivityArray;
+	typedef std::array<DetectionResult, Appearance_Count>	AppearanceArray;
+	typedef std::array<DetectionResult, Expression_Count>	ExpressionArray;
+
+	Body();
+	//! A tracked body with no joints, for skeleton sources other than the
+	//! sensor. Fill it in with setJoint().
+	Body( uint64_t id, uint8_t index );
+
+	float												calcConfidence( bool weighted = false ) const;
+
+	const ActivityArray&								getActivities() const;
+	const AppearanceArray&								getAppearances() const;
+	const ExpressionArray&								getExpressions() const;
+	const Hand&											getHandLeft() const;
+	const Hand&											getHandRight() const;
+	uint64_t											getId() const;
+	uint8_t												getIndex() const;
+	const ci::vec2&										getLean() const;
+	TrackingState										getLeanTrackingState() const;
+	DetectionResult										isEngaged() const;
+	bool												isRestricted() const;
+	bool												isTracked() const;
+
+	//! True when the capture filled in \a jointType.
+	bool												hasJoint( JointType jointType ) const;
+	const ci::quat&										getJointOrientation( JointType jointType ) const;
+	const ci::vec3&										getJointPosition( JointType jointType ) const;
+	TrackingState										getJointTrackingState( JointType jointType ) const;
+	//! Map-style view of the joints for code written against the old std::map.
+	JointMap											getJointMap() const;
+
+	void												setJoint( JointType jointType, const ci::vec3& position, 
+															const ci::quat& orientation = ci::quat(), TrackingState trackingState = TrackingState_Tracked );
+protected:
+	ActivityArray										mActivities;
+	AppearanceArray										mAppearances;
+	DetectionResult										mEngaged;
+	ExpressionArray										mExpressions;
+	Hand												mHands[ 2 ];
+	uint64_t											mId;
+	uint8_t												mIndex;
+	ci::vec2											mLean;
+	TrackingState										mLeanTrackingState;
+	bool												mRestricted;
+	bool												mTracked;
+
+	// Joints, one slot per JointType. mJointMask flags the slots that were filled.
+	uint32_t											mJointMask;
+	ci::quat											mJointOrientations[ JointType_Count ];
+	ci::vec3											mJointPositions[ JointType_Count ];
+	TrackingState										mJointTrackingStates[ JointType_Count ];
+
+	friend class										Device;
+	friend class										RecordingReader;
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+
+class Frame
+{
+public:
+	Frame();
+
+	//! When the frame reached the host, read from the Source's arrival
+	//! clock as it was acquired. Zero for frames no Source delivered.
+	long long											getArrivalTime() const;
+	long long											getTimeStamp() const;
+protected:
+	long long											mArrivalTime;
+	long long											mTimeStamp;
+
+	friend class										Device;
+	friend class										RecordingReader;
+	friend class										Replay;
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+
+class CameraFrame
+{
+public:
+	CameraFrame();
+
+	float												getFovDiagonal() const;
+	float												getFovHorizontal() const;
+	float												getFovVertical() const;
+	const ci::ivec2&									getSize() const;
+protected:
+	float												mFovDiagonal;
+	float												mFovHorizontal;
+	float												mFovVertical;
+	ci::ivec2											mSize;
+
+	friend class										Device;
+	friend class										RecordingReader;
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+
+class BodyFrame : public Frame
+{
+public:
+	BodyFrame();
+	BodyFrame( long long timeStamp, const std::vector<Body>& bodies );
+
+	const std::vector<Body>&							getBodies() const;
+protected:
+	std::vector<Body>									mBodies;
+
+	friend class										Device;
+	friend class										RecordingReader;
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+
+template<typename T>
+class ChannelFrameT : public Frame
+{
+public:
+	ChannelFrameT();
+
+	const std::shared_ptr<ci::ChannelT<T> >&			getChannel() const;
+protected:
+	std::shared_ptr<ci::ChannelT<T> >					mChannel;
+
+	friend class										Device;
+	friend class										RecordingReader;
+};
+
+typedef ChannelFrameT<uint8_t>							ChannelFrame8u;
+typedef ChannelFrameT<uint16_t>							ChannelFrame16u;
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+
+class ColorFrame : public CameraFrame, public Frame
+{
+public:
+	ColorFrame();
+
+	const ci::Surface8uRef&								getSurface() const;
+protected:
+	ci::Surface8uRef									mSurface;
+
+	friend class										Device;
+	friend class										RecordingReader;
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+
+class DepthFrame : public CameraFrame, public ChannelFrame16u
+{
+public:
+	DepthFrame();
+protected:
+	friend class										Device;
+	friend class										RecordingReader;
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+
+typedef ChannelFrame8u									BodyIndexFrame;
+typedef ChannelFrame16u									InfraredFrame;
+
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "cinder/Vector.h"
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace Kinect2 {
+
+//! Occupancy counters for a FramePool, sampled at the last acquire.
+class FramePoolStats
+{
+public:
+	FramePoolStats();
+
+	size_t												getCapacity() const;
+	size_t												getNumAllocated() const;
+	size_t												getNumInUse() const;
+	uint64_t											getNumExhausted() const;
+protected:
+	size_t												mCapacity;
+	size_t												mNumAllocated;
+	size_t												mNumInUse;
+	uint64_t											mNumExhausted;
+
+	template<typename T>
+	friend class										FramePool;
+};
+
+//! Bounded pool of channel or surface buffers for one capture stream. The
+//! pool keeps a reference to every buffer it hands out; a buffer becomes
+//! free again once all consumers have released their references, so
+//! recycling needs no allocations and no custom deleters. acquire() must
+//! only be called from the producer thread.
+template<typename T>
+class FramePool
+{
+public:
+	static const size_t									kDefaultCapacity = 6;
+
+	explicit FramePool( size_t capacity = kDefaultCapacity )
+		: mCapacity( capacity ), mNumAllocated( 0 ), mNumExhausted( 0 ), mNumInUse( 0 )
+	{
+		mBuffers.reserve( capacity );
+	}
+
+	FramePool( const FramePool& ) = delete;
+	FramePool&											operator=( const FramePool& ) = delete;
+
+	//! Returns a free buffer of \a size, calling \a create for a new one while
+	//! the pool is under capacity. Returns nullptr when every buffer is in use.
+	template<typename CreateT>
+	std::shared_ptr<T>									acquire( const ci::ivec2& size, CreateT create )
+	{
+		std::shared_ptr<T>* found	= nullptr;
+		size_t inUse				= 1;
+		for ( std::shared_ptr<T>& buffer : mBuffers ) {
+			if ( buffer.use_count() > 1 ) {
+				++inUse;
+			} else if ( found == nullptr ) {
+				found = &buffer;
+			}
+		}
+		if ( found != nullptr ) {
+			// Pairs with the release of the consumer's last reference
+			std::atomic_thread_fence( std::memory_order_acquire );
+			if ( ( *found )->getSize() != size ) {
+				*found = create();
+			}
+		} else if ( mBuffers.size() < mCapacity ) {
+			mBuffers.push_back( create() );
+			found = &mBuffers.back();
+			mNumAllocated.store( mBuffers.size(), std::memory_order_relaxed );
+		} else {
+			mNumExhausted.fetch_add( 1, std::memory_order_relaxed );
+			mNumInUse.store( mBuffers.size(), std::memory_order_relaxed );
+			return nullptr;
+		}
+		mNumInUse.store( inUse, std::memory_order_relaxed );
+		return *found;
+	}
+
+	//! Safe to call from any thread.
+	FramePoolStats										getStats() const
+	{
+		FramePoolStats stats;
+		stats.mCapacity		= mCapacity;
+		stats.mNumAllocated	= mNumAllocated.load( std::memory_order_relaxed );
+		stats.mNumExhausted	= mNumExhausted.load( std::memory_order_relaxed );
+		stats.mNumInUse		= mNumInUse.load( std::memory_order_relaxed );
+		return stats;
+	}
+protected:
+	std::vector<std::shared_ptr<T> >					mBuffers;
+	size_t												mCapacity;
+	std::atomic<size_t>									mNumAllocated;
+	std::atomic<uint64_t>								mNumExhausted;
+	std::atomic<size_t>									mNumInUse;
+};
+
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include "Kinect2Frame.h"
+#include "cinder/Exception.h"
+#include "cinder/Filesystem.h"
+#include <fstream>
+
+namespace Kinect2 {
+
+class MappedFile;
+class RecordingReader;
+class RecordingWriter;
+typedef std::shared_ptr<RecordingReader>	RecordingReaderRef;
+typedef std::shared_ptr<RecordingWriter>	RecordingWriterRef;
+
+//! Record types stored in a Kinect2 recording, in arrival order.
+enum : uint8_t
+{
+	RecordType_Body,
+	RecordType_BodyIndex,
+	RecordType_Depth,
+	RecordType_Count
+} typedef RecordType;
+
+//! Entry in the frame index at the end of a recording. Timestamps are
+//! absolute here; records in the data section store varint deltas.
+struct RecordIndexEntry
+{
+	uint64_t											mOffset;
+	int64_t												mTimeStamp;
+	uint32_t											mSize;
+	uint8_t												mType;
+	uint8_t												mReserved[ 3 ];
+};
+
+class ExcRecordingOpenFailed : public ci::Exception
+{
+public:
+	ExcRecordingOpenFailed( const ci::fs::path& path );
+};
+
+class ExcRecordingInvalid : public ci::Exception
+{
+public:
+	ExcRecordingInvalid( const ci::fs::path& path );
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+
+//! Appends body, body index and depth frames to a recording file. Call the
+//! write methods from the Source event handlers. Joint positions are stored
+//! in millimeters and orientations as 32-bit smallest-three quaternions.
+//! The frame index is written when the writer is destroyed; recordings cut
+//! short are re-indexed by the reader.
+class RecordingWriter
+{
+public:
+	static RecordingWriterRef							create( const ci::fs::path& path );
+	~RecordingWriter();
+
+	void												writeBodyFrame( const BodyFrame& frame );
+	void												writeBodyIndexFrame( const BodyIndexFrame& frame );
+	void												writeDepthFrame( const DepthFrame& frame );
+
+	size_t												getNumRecords() const;
+	uint64_t											getNumBytesWritten() const;
+protected:
+	RecordingWriter( const ci::fs::path& path );
+
+	template<typename T>
+	void												writeChannel( RecordType type, const ChannelFrameT<T>& frame );
+	void												writeRecord( RecordType type, long long timeStamp, const uint8_t* payload, size_t size );
+	void												writeBytes( const void* data, size_t size );
+
+	std::ofstream										mStream;
+	std::vector<RecordIndexEntry>						mIndex;
+	std::vector<uint8_t>								mPayload;
+	uint64_t											mOffset;
+	long long											mPrevTimeStamp;
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+
+//! Reads a recording through a memory mapping. Body frames are decoded into
+//! a reused frame; depth and body index channels point straight into the
+//! mapping, which they keep alive, so no pixel data is copied. Only the
+//! small Channel object of each channel frame is allocated. The index is
+//! checked against the file when it is opened and each payload when it is
+//! decoded; a corrupt recording throws ExcRecordingInvalid.
+class RecordingReader
+{
+public:
+	static RecordingReaderRef							create( const ci::fs::path& path );
+	~RecordingReader();
+
+	//! Advances to the next record. Returns false at the end of the recording.
+	bool												next();
+	//! Returns to the first record.
+	void												rewind();
+	//! Positions the reader so that next() returns the record at \a index.
+	void												seek( size_t index );
+	//! Positions the reader so that next() returns the first record, in
+	//! file order, at or after \a timeStamp. Binary search when the records
+	//! are in time stamp order, which interleaved streams need not be; a
+	//! linear scan otherwise.
+	void												seekTime( long long timeStamp );
+
+	size_t												getNumRecords() const;
+	long long											getStartTimeStamp() const;
+	long long											getEndTimeStamp() const;
+
+	RecordType											getRecordType() const;
+	long long											getTimeStamp() const;
+
+	const BodyFrame&									getBodyFrame();
+	BodyIndexFrame										getBodyIndexFrame() const;
+	DepthFrame											getDepthFrame() const;
+protected:
+	RecordingReader( const ci::fs::path& path );
+
+	void												buildIndex();
+	template<typename T>
+	void												readChannel( ChannelFrameT<T>& frame ) const;
+	const uint8_t*										getPayload() const;
+	size_t												getPayloadSize() const;
+
+	std::shared_ptr<MappedFile>							mFile;
+	const RecordIndexEntry*								mIndex;
+	size_t												mNumRecords;
+	std::vector<RecordIndexEntry>						mRebuiltIndex;
+	size_t												mPosition;
+	//! Whether the index is in time stamp order, for seekTime().
+	bool												mOrdered;
+	BodyFrame											mBodyFrame;
+	ci::fs::path										mPath;
+};
+
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "Kinect2Recording.h"
+#include "Kinect2Source.h"
+#include "cinder/Signals.h"
+#include <chrono>
+
+namespace Kinect2 {
+
+class Replay;
+typedef std::shared_ptr<Replay>	ReplayRef;
+
+//! Plays a recording back through the Source interface. In real-time mode
+//! frames are delivered on the app update signal according to their sensor
+//! time stamps; unthrottled mode delivers one body frame per update so the
+//! app processes recordings as fast as its loop runs.
+class Replay : public Source
+{
+public:
+	static ReplayRef									create( const ci::fs::path& path, bool realTime = true, bool loop = false );
+	~Replay() override;
+
+	void												start() override;
+	void												stop() override;
+
+	void												connectBodyEventHandler( const std::function<void ( const BodyFrame& )>& eventHandler ) override;
+	void												connectBodyIndexEventHandler( const std::function<void ( const BodyIndexFrame& )>& eventHandler ) override;
+	void												connectDepthEventHandler( const std::function<void ( const DepthFrame& )>& eventHandler ) override;
+
+	void												enableLoop( bool enable = true );
+	void												enableRealTime( bool enable = true );
+	bool												isFinished() const;
+	bool												isLoopEnabled() const;
+	bool												isRealTimeEnabled() const;
+	size_t												getNumBodyFramesDelivered() const;
+protected:
+	Replay( const ci::fs::path& path, bool realTime, bool loop );
+
+	virtual void										update();
+	void												deliver();
+	bool												readNext();
+
+	RecordingReaderRef									mReader;
+	BodyFrame											mBodyFrame;
+	ci::signals::Connection								mUpdateConnection;
+
+	std::function<void ( const BodyFrame& )>			mEventHandlerBody;
+	std::function<void ( const BodyIndexFrame& )>		mEventHandlerBodyIndex;
+	std::function<void ( const DepthFrame& )>			mEventHandlerDepth;
+
+	bool												mEnabledLoop;
+	bool												mEnabledRealTime;
+	bool												mFinished;
+	bool												mPending;
+	bool												mRunning;
+	size_t												mNumBodyFramesDelivered;
+	long long											mTimeStampOrigin;
+	std::chrono::steady_clock::time_point				mTimeOrigin;
+};
+
+}
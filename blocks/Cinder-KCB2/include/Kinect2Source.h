@@ -0,0 +1,42 @@
+#pragma once
+
+#include "Kinect2Frame.h"
+#include <functional>
+
+namespace Kinect2 {
+
+class Source;
+typedef std::shared_ptr<Source>	SourceRef;
+
+//! Platform-neutral provider of body, body index and depth frames.
+//! Implemented by Device for live sensor data and by Replay for recordings.
+class Source
+{
+public:
+	virtual ~Source();
+
+	virtual void										start() = 0;
+	virtual void										stop() = 0;
+
+	virtual void										connectBodyEventHandler( const std::function<void ( const BodyFrame& )>& eventHandler ) = 0;
+	virtual void										connectBodyIndexEventHandler( const std::function<void ( const BodyIndexFrame& )>& eventHandler ) = 0;
+	virtual void										connectDepthEventHandler( const std::function<void ( const DepthFrame& )>& eventHandler ) = 0;
+
+	//! Projects a camera space point into the 512x424 depth image. The default
+	//! uses the nominal Kinect v2 depth intrinsics; Device uses the sensor's mapper.
+	virtual ci::ivec2									mapCameraToDepth( const ci::vec3& v ) const;
+
+	//! Clock read on the capture thread as each frame is acquired, for
+	//! Frame::getArrivalTime(), in microseconds. Frames are handed to the
+	//! event handlers on the app thread later; this time does not wait for
+	//! it. Defaults to std::chrono::steady_clock. Set it before start().
+	void												setArrivalClock( const std::function<long long ()>& clock );
+protected:
+	Source();
+
+	long long											readArrivalClock() const;
+
+	std::function<long long ()>							mArrivalClock;
+};
+
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <utility>
+
+namespace Kinect2 {
+
+//! Lock-free single-producer/single-consumer handoff of the latest value,
+//! after ableton::link::TripleBuffer. The producer never waits on the
+//! consumer; a value that is replaced before it is read counts as dropped.
+template<typename T>
+class TripleBuffer
+{
+public:
+	TripleBuffer()
+		: mState( 1 ), mRead( 0 ), mWrite( 2 )
+	{
+	}
+
+	TripleBuffer( const TripleBuffer& ) = delete;
+	TripleBuffer&										operator=( const TripleBuffer& ) = delete;
+
+	//! Producer side. Publishes \a value. Returns true when the previous value was never read.
+	bool												write( T value )
+	{
+		mBuffers[ mWrite ]		= std::move( value );
+		const uint32_t prev		= mState.exchange( mWrite | kDirty, std::memory_order_acq_rel );
+		mWrite					= prev & kIndexMask;
+		return ( prev & kDirty ) != 0;
+	}
+
+	//! Consumer side. Switches to the newest value. Returns false when nothing new was written.
+	bool												readNew()
+	{
+		if ( ( mState.load( std::memory_order_acquire ) & kDirty ) == 0 ) {
+			return false;
+		}
+		const uint32_t prev	= mState.exchange( mRead, std::memory_order_acq_rel );
+		mRead				= prev & kIndexMask;
+		return true;
+	}
+
+	//! Consumer side. The value returned by the last successful readNew().
+	const T&											read() const
+	{
+		return mBuffers[ mRead ];
+	}
+protected:
+	static const uint32_t								kDirty		= 4;
+	static const uint32_t								kIndexMask	= 3;
+
+	T													mBuffers[ 3 ];
+	std::atomic<uint32_t>								mState;
+	uint32_t											mRead;
+	uint32_t											mWrite;
+};
+
+}
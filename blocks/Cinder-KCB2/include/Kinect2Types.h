@@ -0,0 +1,112 @@
+#pragma once
+
+#include "cinder/Cinder.h"
+
+#if defined( CINDER_MSW )
+
+#include "KCBv2Lib.h"
+
+#else
+
+// Subset of the Kinect for Windows SDK 2.0 body types (Kinect.h) needed to
+// carry body, depth and body index frames on platforms without the SDK.
+// Values must match the SDK so recordings are portable between platforms.
+
+#include <cstdint>
+
+#ifndef BODY_COUNT
+#define BODY_COUNT 6
+#endif
+
+enum _JointType
+{
+	JointType_SpineBase		= 0,
+	JointType_SpineMid		= 1,
+	JointType_Neck			= 2,
+	JointType_Head			= 3,
+	JointType_ShoulderLeft	= 4,
+	JointType_ElbowLeft		= 5,
+	JointType_WristLeft		= 6,
+	JointType_HandLeft		= 7,
+	JointType_ShoulderRight	= 8,
+	JointType_ElbowRight	= 9,
+	JointType_WristRight	= 10,
+	JointType_HandRight		= 11,
+	JointType_HipLeft		= 12,
+	JointType_KneeLeft		= 13,
+	JointType_AnkleLeft		= 14,
+	JointType_FootLeft		= 15,
+	JointType_HipRight		= 16,
+	JointType_KneeRight		= 17,
+	JointType_AnkleRight	= 18,
+	JointType_FootRight		= 19,
+	JointType_SpineShoulder	= 20,
+	JointType_HandTipLeft	= 21,
+	JointType_ThumbLeft		= 22,
+	JointType_HandTipRight	= 23,
+	JointType_ThumbRight	= 24,
+	JointType_Count			= ( JointType_ThumbRight + 1 )
+};
+typedef enum _JointType JointType;
+
+enum _TrackingState
+{
+	TrackingState_NotTracked	= 0,
+	TrackingState_Inferred		= 1,
+	TrackingState_Tracked		= 2
+};
+typedef enum _TrackingState TrackingState;
+
+enum _HandState
+{
+	HandState_Unknown		= 0,
+	HandState_NotTracked	= 1,
+	HandState_Open			= 2,
+	HandState_Closed		= 3,
+	HandState_Lasso			= 4
+};
+typedef enum _HandState HandState;
+
+enum _TrackingConfidence
+{
+	TrackingConfidence_Low	= 0,
+	TrackingConfidence_High	= 1
+};
+typedef enum _TrackingConfidence TrackingConfidence;
+
+enum _DetectionResult
+{
+	DetectionResult_Unknown	= 0,
+	DetectionResult_No		= 1,
+	DetectionResult_Maybe	= 2,
+	DetectionResult_Yes		= 3
+};
+typedef enum _DetectionResult DetectionResult;
+
+enum _Activity
+{
+	Activity_EyeLeftClosed	= 0,
+	Activity_EyeRightClosed	= 1,
+	Activity_MouthOpen		= 2,
+	Activity_MouthMoved		= 3,
+	Activity_LookingAway	= 4,
+	Activity_Count			= ( Activity_LookingAway + 1 )
+};
+typedef enum _Activity Activity;
+
+enum _Appearance
+{
+	Appearance_WearingGlasses	= 0,
+	Appearance_Count			= ( Appearance_WearingGlasses + 1 )
+};
+typedef enum _Appearance Appearance;
+
+enum _Expression
+{
+	Expression_Neutral	= 0,
+	Expression_Happy	= 1,
+	Expression_Count	= ( Expression_Happy + 1 )
+};
+typedef enum _Expression Expression;
+
+#endif
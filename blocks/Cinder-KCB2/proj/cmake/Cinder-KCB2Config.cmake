@@ -6,17 +6,38 @@ if( NOT TARGET Cinder-KCB2 )
 	set(KINECT_INCLUDE_DIR "C:/Program Files/Microsoft SDKs/Kinect/v2.0_1409/inc")
 	set(KINECT_LIB_DIR "C:/Program Files/Microsoft SDKs/Kinect/v2.0_1409/lib")
 
+	# Frame types, the Source interface and recording/replay build on every
+	# platform; the sensor Device requires the Kinect for Windows SDK.
 	set( Cinder-KCB2_INCLUDES
-		${Cinder-KCB2_INC_PATH}/Kinect2.h
-		${Cinder-KCB2_LIB_PATH}/KCBv2Lib.h
+		${Cinder-KCB2_INC_PATH}/Kinect2Frame.h
+		${Cinder-KCB2_INC_PATH}/Kinect2FramePool.h
+		${Cinder-KCB2_INC_PATH}/Kinect2Recording.h
+		${Cinder-KCB2_INC_PATH}/Kinect2Replay.h
+		${Cinder-KCB2_INC_PATH}/Kinect2Source.h
+		${Cinder-KCB2_INC_PATH}/Kinect2TripleBuffer.h
+		${Cinder-KCB2_INC_PATH}/Kinect2Types.h
 	)
 
-	message(KCB2_LIB_PATH.................${Cinder-KCB2_LIB_PATH})
-
 	set( Cinder-KCB2_SOURCES
-		${Cinder-KCB2_SOURCE_PATH}/Kinect2.cpp
+		${Cinder-KCB2_SOURCE_PATH}/Kinect2Frame.cpp
+		${Cinder-KCB2_SOURCE_PATH}/Kinect2FramePool.cpp
+		${Cinder-KCB2_SOURCE_PATH}/Kinect2Recording.cpp
+		${Cinder-KCB2_SOURCE_PATH}/Kinect2Replay.cpp
+		${Cinder-KCB2_SOURCE_PATH}/Kinect2Source.cpp
 	)
 
+	if( WIN32 )
+		message(KCB2_LIB_PATH.................${Cinder-KCB2_LIB_PATH})
+
+		list( APPEND Cinder-KCB2_INCLUDES
+			${Cinder-KCB2_INC_PATH}/Kinect2.h
+			${Cinder-KCB2_LIB_PATH}/KCBv2Lib.h
+		)
+		list( APPEND Cinder-KCB2_SOURCES
+			${Cinder-KCB2_SOURCE_PATH}/Kinect2.cpp
+		)
+	endif()
+
 	list( APPEND Cinder-KCB2_LIBRARIES
 		${Cinder-KCB2_INCLUDES}
 		${Cinder-KCB2_SOURCES}
@@ -28,18 +49,20 @@ if( NOT TARGET Cinder-KCB2 )
 	add_library( Cinder-KCB2 ${Cinder-KCB2_LIBRARIES} )
 	target_include_directories( Cinder-KCB2 PUBLIC "${CINDER_PATH}/include" ${KINECT_INCLUDE_DIR} ${Cinder-KCB2_LIB_PATH} ${Cinder-KCB2_INC_PATH} )
 	#target_include_directories( ${PROJECT_NAME} PUBLIC ${KINECT_INCLUDE_DIR} ${Cinder-KCB2_LIB_PATH} ${Cinder-KCB2_INC_PATH} )
-	target_link_libraries(Cinder-KCB2 PUBLIC
-		${Cinder-KCB2_LIB_PATH}/x64/KCBv2.lib
-		${KINECT_LIB_DIR}/x64/kinect20.lib
-		${KINECT_LIB_DIR}/x64/Kinect20.Face.lib
-	)
+	if( WIN32 )
+		target_link_libraries(Cinder-KCB2 PUBLIC
+			${Cinder-KCB2_LIB_PATH}/x64/KCBv2.lib
+			${KINECT_LIB_DIR}/x64/kinect20.lib
+			${KINECT_LIB_DIR}/x64/Kinect20.Face.lib
+		)
 
-	add_custom_command( TARGET ${PROJECT_NAME} POST_BUILD
-		COMMAND ${CMAKE_COMMAND} -E copy ${Cinder-KCB2_LIB_PATH}/x64/KCBv2.dll ${CMAKE_CURRENT_BINARY_DIR}/${PROJECT_NAME}/$<$<CONFIG:Debug>:Debug>$<$<CONFIG:Release>:Release>$<$<CONFIG:RelWithDebInfo>:RelWithDebInfo>/
-		COMMENT "Copied KCBv2.dll."
-	)
-	add_custom_command( TARGET ${PROJECT_NAME} POST_BUILD
-		COMMAND ${CMAKE_COMMAND} -E copy ${KINECT_LIB_DIR}/../bin/Kinect20.Face.dll ${CMAKE_CURRENT_BINARY_DIR}/${PROJECT_NAME}/$<$<CONFIG:Debug>:Debug>$<$<CONFIG:Release>:Release>$<$<CONFIG:RelWithDebInfo>:RelWithDebInfo>/
-		COMMENT "Copied Kinect20.Face.dll."
-	)
+		add_custom_command( TARGET ${PROJECT_NAME} POST_BUILD
+			COMMAND ${CMAKE_COMMAND} -E copy ${Cinder-KCB2_LIB_PATH}/x64/KCBv2.dll ${CMAKE_CURRENT_BINARY_DIR}/${PROJECT_NAME}/$<$<CONFIG:Debug>:Debug>$<$<CONFIG:Release>:Release>$<$<CONFIG:RelWithDebInfo>:RelWithDebInfo>/
+			COMMENT "Copied KCBv2.dll."
+		)
+		add_custom_command( TARGET ${PROJECT_NAME} POST_BUILD
+			COMMAND ${CMAKE_COMMAND} -E copy ${KINECT_LIB_DIR}/../bin/Kinect20.Face.dll ${CMAKE_CURRENT_BINARY_DIR}/${PROJECT_NAME}/$<$<CONFIG:Debug>:Debug>$<$<CONFIG:Release>:Release>$<$<CONFIG:RelWithDebInfo>:RelWithDebInfo>/
+			COMMENT "Copied Kinect20.Face.dll."
+		)
+	endif()
 endif()
@@ -59,68 +59,6 @@ static const unsigned long kFaceFrameFeatures =
 	FaceFrameFeatures::FaceFrameFeatures_Glasses					| 
 	FaceFrameFeatures::FaceFrameFeatures_FaceEngagement;
 
-Channel8uRef channel16To8( const Channel16uRef& channel, uint8_t bytes )
-{
-	Channel8uRef channel8;
-	if ( channel ) {
-		channel8				= Channel8u::create( channel->getWidth(), channel->getHeight() );
-		Channel16u::Iter iter16	= channel->getIter();
-		Channel8u::Iter iter8	= channel8->getIter();
-		while ( iter8.line() && iter16.line() ) {
-			while ( iter8.pixel() && iter16.pixel() ) {
-				iter8.v()				= static_cast<uint8_t>( iter16.v() >> bytes );
-			}
-		}
-	}
-	return channel8;
-}
-
-Surface8uRef colorizeBodyIndex( const Channel8uRef& bodyIndexChannel )
-{
-	Surface8uRef surface;
-	if ( bodyIndexChannel ) {
-		surface = Surface8u::create( bodyIndexChannel->getWidth(), bodyIndexChannel->getHeight(), true, SurfaceChannelOrder::RGBA );
-		Channel8u::Iter iterChannel	= bodyIndexChannel->getIter();
-		Surface8u::Iter iterSurface	= surface->getIter();
-		while ( iterChannel.line() && iterSurface.line() ) {
-			while ( iterChannel.pixel() && iterSurface.pixel() ) {
-				size_t index				= (size_t)iterChannel.v();
-				ColorA8u color( getBodyColor( index ), 0xFF );
-				if ( index == 0 || index > BODY_COUNT ) {
-					color.a		= 0x00;
-				}
-				iterSurface.r()	= color.r;
-				iterSurface.g()	= color.g;
-				iterSurface.b()	= color.b;
-				iterSurface.a()	= color.a;
-			}
-		}
-	}
-	return surface;
-}
-
-Color8u getBodyColor( size_t index )
-{
-	switch ( index ) {
-	case 0:
-		return Color8u::black();
-	case 1:
-		return Color8u( 0xFF, 0x00, 0x00 );
-	case 2:
-		return Color8u( 0x00, 0xFF, 0x00 );
-	case 3:
-		return Color8u( 0x00, 0x00, 0xFF );
-	case 4:
-		return Color8u( 0xFF, 0xFF, 0x00 );
-	case 5:
-		return Color8u( 0x00, 0xFF, 0xFF );
-	case 6:
-		return Color8u( 0xFF, 0x00, 0xFF );
-	default:
-		return Color8u::white();
-	}
-}
-
 // FOR FUTURE USE
 size_t getDeviceCount()
 {
@@ -408,238 +346,12 @@ const ColorA8u& Face3d::getSkinColor() const
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 
-Body::Hand::Hand()
-: mConfidence( TrackingConfidence_Low ), mState( HandState_Unknown )
-{
-}
-
-TrackingConfidence Body::Hand::getConfidence() const
-{
-	return mConfidence;
-}
-
-HandState Body::Hand::getState() const
-{
-	return mState;
-}
-
-//////////////////////////////////////////////////////////////////////////////////////////////
-
-Body::Joint::Joint()
-: mOrientation( quat() ), mParentJoint( JointType::JointType_Count ), mPosition( vec3( 0.0f ) ), 
-mTrackingState( TrackingState_NotTracked )
-{
-}
-
-Body::Joint::Joint( const vec3& position, const quat& orientation, TrackingState trackingState,
-	JointType parentJoint )
-: mOrientation( orientation ), mPosition( position ), mParentJoint( parentJoint ), 
-mTrackingState( trackingState )
-{
-}
-
-JointType Body::Joint::getParentJoint() const
-{
-	return mParentJoint;
-}
-
-const vec3& Body::Joint::getPosition() const
-{
-	return mPosition;
-}
-
-const quat& Body::Joint::getOrientation() const
-{
-	return mOrientation;
-}
-
-TrackingState Body::Joint::getTrackingState() const
-{
-	return mTrackingState;
-}
-
-//////////////////////////////////////////////////////////////////////////////////////////////
-
-Body::Body()
-: mEngaged( DetectionResult_Unknown ), mId( 0 ), mIndex( 0 ), 
-mLean( vec2( 0.0f ) ), mLeanTrackingState( TrackingState_NotTracked ), 
-mRestricted( false ), mTracked( false )
-{
-	for ( size_t i = 0; i < (size_t)Activity_Count; ++i ) {
-		mActivities[ (Activity)i ] = DetectionResult_Unknown;
-	}
-	for ( size_t i = 0; i < (size_t)Appearance_Count; ++i ) {
-		mAppearances[ (Appearance)i ] = DetectionResult_Unknown;
-	}
-	for ( size_t i = 0; i < (size_t)Expression_Count; ++i ) {
-		mExpressions[ (Expression)i ] = DetectionResult_Unknown;
-	}
-}
-
-float Body::calcConfidence( bool weighted ) const
-{
-	float c = 0.0f;
-	if ( weighted ) {
-		static map<JointType, float> weights;
-		if ( weights.empty() ) {
-			weights[ JointType::JointType_SpineBase ]		= 0.042553191f;
-			weights[ JointType::JointType_SpineMid ]		= 0.042553191f;
-			weights[ JointType::JointType_Neck ]			= 0.021276596f;
-			weights[ JointType::JointType_Head ]			= 0.042553191f;
-			weights[ JointType::JointType_ShoulderLeft ]	= 0.021276596f;
-			weights[ JointType::JointType_ElbowLeft ]		= 0.010638298f;
-			weights[ JointType::JointType_WristLeft ]		= 0.005319149f;
-			weights[ JointType::JointType_HandLeft ]		= 0.042553191f;
-			weights[ JointType::JointType_ShoulderRight ]	= 0.021276596f;
-			weights[ JointType::JointType_ElbowRight ]		= 0.010638298f;
-			weights[ JointType::JointType_WristRight ]		= 0.005319149f;
-			weights[ JointType::JointType_HandRight ]		= 0.042553191f;
-			weights[ JointType::JointType_HipLeft ]			= 0.021276596f;
-			weights[ JointType::JointType_KneeLeft ]		= 0.010638298f;
-			weights[ JointType::JointType_AnkleLeft ]		= 0.005319149f;
-			weights[ JointType::JointType_FootLeft ]		= 0.042553191f;
-			weights[ JointType::JointType_HipRight ]		= 0.021276596f;
-			weights[ JointType::JointType_KneeRight ]		= 0.010638298f;
-			weights[ JointType::JointType_AnkleRight ]		= 0.005319149f;
-			weights[ JointType::JointType_FootRight ]		= 0.042553191f;
-			weights[ JointType::JointType_SpineShoulder ]	= 0.002659574f;
-			weights[ JointType::JointType_HandTipLeft ]		= 0.002659574f;
-			weights[ JointType::JointType_ThumbLeft ]		= 0.002659574f;
-			weights[ JointType::JointType_HandTipRight ]	= 0.002659574f;
-			weights[ JointType::JointType_ThumbRight ]		= 0.521276596f;
-		}
-		for ( map<JointType, Joint>::const_iterator iter = mJointMap.begin(); iter != mJointMap.end(); ++iter ) {
-			if ( iter->second.getTrackingState() == TrackingState::TrackingState_Tracked ) {
-				c += weights[ iter->first ];
-			}
-		}
-	} else {
-		for ( map<JointType, Joint>::const_iterator iter = mJointMap.begin(); iter != mJointMap.end(); ++iter ) {
-			if ( iter->second.getTrackingState() == TrackingState::TrackingState_Tracked ) {
-				c += 1.0f;
-			}
-		}
-		c /= (float)JointType::JointType_Count;
-	}
-	return c;
-}
-
-const map<Activity, DetectionResult>& Body::getActivities() const
-{
-	return mActivities;
-}
-
-const map<Appearance, DetectionResult>& Body::getAppearances() const
-{
-	return mAppearances;
-}
-
-const map<Expression, DetectionResult>& Body::getExpressions() const
-{
-	return mExpressions;
-}
-
-const Body::Hand& Body::getHandLeft() const
-{
-	return mHands[ 0 ];
-}
-
-const Body::Hand& Body::getHandRight() const
-{
-	return mHands[ 1 ];
-}
-
-uint64_t Body::getId() const 
-{ 
-	return mId; 
-}
-
-uint8_t Body::getIndex() const 
-{ 
-	return mIndex; 
-}
-
-const map<JointType, Body::Joint>& Body::getJointMap() const 
-{ 
-	return mJointMap; 
-}
-
-const vec2& Body::getLean() const
-{
-	return mLean;
-}
-
-TrackingState Body::getLeanTrackingState() const
-{
-	return mLeanTrackingState;
-}
-
-DetectionResult Body::isEngaged() const
-{
-	return mEngaged;
-}
-
-bool Body::isTracked() const 
-{ 
-	return mTracked; 
-}
-
-//////////////////////////////////////////////////////////////////////////////////////////////
-
-Frame::Frame()
-: mTimeStamp( 0L )
-{
-}
-
-long long Frame::getTimeStamp() const
-{
-	return mTimeStamp;
-}
-
-//////////////////////////////////////////////////////////////////////////////////////////////
-
-CameraFrame::CameraFrame()
-: mFovDiagonal( 0.0f ), mFovHorizontal( 0.0f ), 
-mFovVertical( 0.0f ), mSize( ivec2( 0 ) )
-{
-}
-
-float CameraFrame::getFovDiagonal() const
-{
-	return mFovDiagonal;
-}
-
-float CameraFrame::getFovHorizontal() const
-{
-	return mFovHorizontal;
-}
-
-float CameraFrame::getFovVertical() const
-{
-	return mFovVertical;
-}
-
-const ivec2& CameraFrame::getSize() const
-{
-	return mSize;
-}
-
-//////////////////////////////////////////////////////////////////////////////////////////////
-
 AudioFrame::AudioFrame()
 	: mBeamAngle( 0.0f ), mBeamAngleConfidence( 0.0f ), mBuffer( nullptr ), 
 	mBufferSize( 0 )
 {
 }
 
-AudioFrame::~AudioFrame()
-{
-	if ( mBuffer != nullptr ) {
-		delete [] mBuffer;
-		mBuffer = nullptr;
-	}
-}
-
 float AudioFrame::getBeamAngle() const
 {
 	return mBeamAngle;
@@ -652,7 +364,7 @@ float AudioFrame::getBeamAngleConfidence() const
 
 uint8_t* AudioFrame::getBuffer() const
 {
-	return mBuffer;
+	return mBuffer.get();
 }
 
 unsigned long AudioFrame::getBufferSize() const
@@ -667,113 +379,133 @@ WAVEFORMATEX AudioFrame::getFormat() const
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 
-BodyFrame::BodyFrame()
+Face2dFrame::Face2dFrame()
 : Frame()
 {
 }
 
-const vector<Body>& BodyFrame::getBodies() const
+const vector<Face2d>& Face2dFrame::getFaces() const
 {
-	return mBodies;
+	return mFaces;
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 
-template<typename T> 
-ChannelFrameT<T>::ChannelFrameT()
+Face3dFrame::Face3dFrame()
 : Frame()
 {
 }
 
-template<typename T> 
-const std::shared_ptr<ChannelT<T> >& ChannelFrameT<T>::getChannel() const
+const vector<Face3d>& Face3dFrame::getFaces() const
 {
-	return mChannel;
+	return mFaces;
 }
 
-template class ChannelFrameT<uint8_t>;
-template class ChannelFrameT<uint16_t>;
-
 //////////////////////////////////////////////////////////////////////////////////////////////
 
-ColorFrame::ColorFrame()
-: CameraFrame(), Frame()
+// KCB exposes no waitable frame events, so enabled streams poll
+// KCBIsFrameReady at this interval instead.
+static const chrono::microseconds kFramePollInterval( 1000 );
+
+Device::Process::Process()
+: mEnabled( atomic<bool>( false ) ), mFrameProduced( false ), mRunning( atomic<bool>( false ) ), 
+mThreadCallback( nullptr ), mTimeStamp( 0L ), mNumFramesDelivered( 0 ), mNumFramesDropped( 0 ), 
+mNumFramesProduced( 0 )
 {
-	mSize = ivec2( 1920, 1080 );
 }
 
-const Surface8uRef& ColorFrame::getSurface() const
+Device::Process::~Process()
 {
-	return mSurface;
+	stop();
 }
 
-//////////////////////////////////////////////////////////////////////////////////////////////
-
-DepthFrame::DepthFrame()
-: CameraFrame(), ChannelFrame16u()
+void Device::Process::start()
 {
-	mSize = ivec2( 512, 424 );
+	stop();
+	if ( mThreadCallback != nullptr ) {
+		mFrameProduced	= false;
+		mRunning		= true;
+		mTimeStamp		= 0L;
+		mThread			= shared_ptr<thread>( new thread( mThreadCallback ) );
+	}
 }
 
-//////////////////////////////////////////////////////////////////////////////////////////////
-
-Face2dFrame::Face2dFrame()
-: Frame()
+void Device::Process::stop()
 {
+	{
+		lock_guard<mutex> lock( mMutex );
+		mRunning = false;
+	}
+	mCondition.notify_all();
+	if ( mThread ) {
+		mThread->join();
+		mThread.reset();
+	}
 }
 
-const vector<Face2d>& Face2dFrame::getFaces() const
+void Device::Process::enable( bool enable )
 {
-	return mFaces;
+	{
+		lock_guard<mutex> lock( mMutex );
+		mEnabled = enable;
+	}
+	mCondition.notify_all();
 }
 
-//////////////////////////////////////////////////////////////////////////////////////////////
-
-Face3dFrame::Face3dFrame()
-: Frame()
+bool Device::Process::wait()
 {
+	unique_lock<mutex> lock( mMutex );
+	if ( !mFrameProduced ) {
+		mCondition.wait_for( lock, kFramePollInterval, [ this ]()
+		{
+			return !mRunning;
+		} );
+	}
+	mFrameProduced = false;
+	mCondition.wait( lock, [ this ]()
+	{
+		return !mRunning || mEnabled;
+	} );
+	return mRunning;
 }
 
-const vector<Face3d>& Face3dFrame::getFaces() const
+void Device::Process::produced( bool dropped )
 {
-	return mFaces;
+	mFrameProduced = true;
+	++mNumFramesProduced;
+	if ( dropped ) {
+		++mNumFramesDropped;
+	}
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 
-Device::Process::Process()
-: mNewData( atomic<bool>( false ) ), mRunning( atomic<bool>( false ) ), 
-mThreadCallback( nullptr )
+Device::StreamStats::StreamStats()
+: mNumFramesDelivered( 0 ), mNumFramesDropped( 0 ), mNumFramesProduced( 0 )
 {
 }
 
-Device::Process::~Process()
+uint64_t Device::StreamStats::getNumFramesDelivered() const
 {
-	stop();
+	return mNumFramesDelivered;
 }
 
-void Device::Process::start()
+uint64_t Device::StreamStats::getNumFramesDropped() const
 {
-	stop();
-	if ( mThreadCallback != nullptr ) {
-		mNewData	= false;
-		mRunning	= true;
-		mThread		= shared_ptr<thread>( new thread( mThreadCallback ) );
-	}
+	return mNumFramesDropped;
 }
 
-void Device::Process::stop()
+uint64_t Device::StreamStats::getNumFramesProduced() const
 {
-	mRunning = false;
-	if ( mThread ) {
-		mThread->join();
-		mThread.reset();
-	}
+	return mNumFramesProduced;
 }
 
-//////////////////////////////////////////////////////////////////////////////////////////////
+const FramePoolStats& Device::StreamStats::getPoolStats() const
+{
+	return mPoolStats;
+}
 
-static const long long kThreadSleepDuration = 30L;
+//////////////////////////////////////////////////////////////////////////////////////////////
 
 uint32_t Device::sFaceModelIndexCount	= 0;
 uint32_t Device::sFaceModelVertexCount	= 0;
@@ -784,8 +516,9 @@ DeviceRef Device::create()
 }
 
 Device::Device()
-	: mEnabledFaceMesh( false ), mEnabledHandTracking( false ), 
-	mEnabledJointTracking( true ), mEventHandlerAudio( nullptr ), 
+	: mBodyFeatures( BodyFeature_Joints | BodyFeature_JointOrientations | BodyFeature_Lean | 
+	BodyFeature_Activities | BodyFeature_Appearances | BodyFeature_Expressions ), 
+	mBodyJointMask( kJointMaskAll ), mEnabledFaceMesh( false ), mEventHandlerAudio( nullptr ), 
 	mEventHandlerBody( nullptr ), mEventHandlerBodyIndex( nullptr ), 
 	mEventHandlerColor( nullptr ), mEventHandlerDepth( nullptr ), 
 	mEventHandlerFace2d( nullptr ), mEventHandlerFace3d( nullptr ), 
@@ -818,91 +551,109 @@ Device::~Device()
 void Device::connectAudioEventHandler( const function<void ( const AudioFrame& )>& eventHandler )
 {
 	mEventHandlerAudio = eventHandler;
+	mProcesses[ FrameType_Audio ].enable( eventHandler != nullptr );
 }
 
 void Device::connectBodyEventHandler( const function<void ( const BodyFrame& )>& eventHandler )
 {
 	mEventHandlerBody = eventHandler;
+	mProcesses[ FrameType_Body ].enable( eventHandler != nullptr );
 }
 
 void Device::connectBodyIndexEventHandler( const function<void ( const BodyIndexFrame& )>& eventHandler )
 {
 	mEventHandlerBodyIndex = eventHandler;
+	mProcesses[ FrameType_BodyIndex ].enable( eventHandler != nullptr );
 }
 
 void Device::connectColorEventHandler( const function<void ( const ColorFrame& )>& eventHandler )
 {
 	mEventHandlerColor = eventHandler;
+	mProcesses[ FrameType_Color ].enable( eventHandler != nullptr );
 }
 
 void Device::connectDepthEventHandler( const function<void ( const DepthFrame& )>& eventHandler )
 {
 	mEventHandlerDepth = eventHandler;
+	mProcesses[ FrameType_Depth ].enable( eventHandler != nullptr );
 }
 
 void Device::connectFace2dEventHandler( const function<void ( const Face2dFrame& )>& eventHandler )
 {
 	mEventHandlerFace2d = eventHandler;
+	mProcesses[ FrameType_Face2d ].enable( eventHandler != nullptr );
 }
 
 void Device::connectFace3dEventHandler( const function<void ( const Face3dFrame& )>& eventHandler )
 {
 	mEventHandlerFace3d = eventHandler;
+	mProcesses[ FrameType_Face3d ].enable( eventHandler != nullptr );
 }
 
 void Device::connectInfraredEventHandler( const function<void ( const InfraredFrame& )>& eventHandler )
 {
 	mEventHandlerInfrared = eventHandler;
+	mProcesses[ FrameType_Infrared ].enable( eventHandler != nullptr );
 }
 
 void Device::connectInfraredLongExposureEventHandler( const function<void ( const InfraredFrame& )>& eventHandler )
 {
 	mEventHandlerInfraredLongExposure = eventHandler;
+	mProcesses[ FrameType_InfraredLongExposure ].enable( eventHandler != nullptr );
 }
 
 void Device::disconnectAudioEventHandler()
 {
 	mEventHandlerAudio = nullptr;
+	mProcesses[ FrameType_Audio ].enable( false );
 }
 
 void Device::disconnectBodyEventHandler()
 {
 	mEventHandlerBody = nullptr;
+	mProcesses[ FrameType_Body ].enable( false );
 }
 
 void Device::disconnectBodyIndexEventHandler()
 {
 	mEventHandlerBodyIndex = nullptr;
+	mProcesses[ FrameType_BodyIndex ].enable( false );
 }
 
 void Device::disconnectColorEventHandler()
 {
 	mEventHandlerColor = nullptr;
+	mProcesses[ FrameType_Color ].enable( false );
 }
 
 void Device::disconnectDepthEventHandler()
 {
 	mEventHandlerDepth = nullptr;
+	mProcesses[ FrameType_Depth ].enable( false );
 }
 
 void Device::disconnectFace2dEventHandler()
 {
 	mEventHandlerFace2d = nullptr;
+	mProcesses[ FrameType_Face2d ].enable( false );
 }
 
 void Device::disconnectFace3dEventHandler()
 {
 	mEventHandlerFace3d = nullptr;
+	mProcesses[ FrameType_Face3d ].enable( false );
 }
 
 void Device::disconnectInfraredEventHandler()
 {
 	mEventHandlerInfrared = nullptr;
+	mProcesses[ FrameType_Infrared ].enable( false );
 }
 
 void Device::disconnectInfraredLongExposureEventHandler()
 {
 	mEventHandlerInfraredLongExposure = nullptr;
+	mProcesses[ FrameType_InfraredLongExposure ].enable( false );
 }
 
 bool Device::isAudioEventHandlerConnected() const
@@ -957,12 +708,21 @@ void Device::enableFaceMesh( bool enable )
 
 void Device::enableHandTracking( bool enable )
 {
-	mEnabledHandTracking = enable;
+	if ( enable ) {
+		mBodyFeatures |= BodyFeature_Hands;
+	} else {
+		mBodyFeatures &= ~(uint32_t)BodyFeature_Hands;
+	}
 }
 
 void Device::enableJointTracking( bool enable )
 {
-	mEnabledJointTracking = enable;
+	const uint32_t joints = BodyFeature_Joints | BodyFeature_JointOrientations;
+	if ( enable ) {
+		mBodyFeatures |= joints;
+	} else {
+		mBodyFeatures &= ~joints;
+	}
 }
 
 bool Device::isFaceMeshEnabled() const
@@ -972,12 +732,28 @@ bool Device::isFaceMeshEnabled() const
 
 bool Device::isHandTrackingEnabled() const
 {
-	return mEnabledHandTracking;
+	return ( mBodyFeatures & BodyFeature_Hands ) != 0;
 }
 
 bool Device::isJointTrackingEnabled() const
 {
-	return mEnabledJointTracking;
+	return ( mBodyFeatures & BodyFeature_Joints ) != 0;
+}
+
+void Device::setBodyFeatures( uint32_t features, uint32_t jointMask )
+{
+	mBodyJointMask	= jointMask & kJointMaskAll;
+	mBodyFeatures	= features & BodyFeature_All;
+}
+
+uint32_t Device::getBodyFeatures() const
+{
+	return mBodyFeatures;
+}
+
+uint32_t Device::getBodyJointMask() const
+{
+	return mBodyJointMask;
 }
 
 ivec2 Device::mapCameraToColor( const vec3& v ) const
@@ -1143,6 +919,37 @@ vector<ivec2> Device::mapDepthToColor( const vector<ivec2>& v, const Channel16uR
 	return p;
 }
 
+Device::StreamStats Device::getStreamStats( FrameType frameType ) const
+{
+	StreamStats stats;
+	if ( frameType < FrameType_Count ) {
+		const Process& process		= mProcesses[ frameType ];
+		stats.mNumFramesDelivered	= process.mNumFramesDelivered;
+		stats.mNumFramesDropped		= process.mNumFramesDropped;
+		stats.mNumFramesProduced	= process.mNumFramesProduced;
+	}
+	switch ( frameType ) {
+	case FrameType_BodyIndex:
+		stats.mPoolStats = mPoolBodyIndex.getStats();
+		break;
+	case FrameType_Color:
+		stats.mPoolStats = mPoolColor.getStats();
+		break;
+	case FrameType_Depth:
+		stats.mPoolStats = mPoolDepth.getStats();
+		break;
+	case FrameType_Infrared:
+		stats.mPoolStats = mPoolInfrared.getStats();
+		break;
+	case FrameType_InfraredLongExposure:
+		stats.mPoolStats = mPoolInfraredLongExposure.getStats();
+		break;
+	default:
+		break;
+	}
+	return stats;
+}
+
 void Device::start()
 {
 	long hr = S_OK;
@@ -1163,19 +970,13 @@ void Device::start()
 	}
 
 	uint8_t sensorIsOpen = isSensorOpen();
-	for ( size_t frameType = (size_t)FrameType_Audio; frameType < (size_t)FrameType_InfraredLongExposure; ++frameType ) {
-		mProcesses[ (FrameType)frameType ]	= Process();
-		Process& process					= mProcesses.at( (FrameType)frameType );
+	for ( size_t frameType = (size_t)FrameType_Audio; frameType < (size_t)FrameType_Count; ++frameType ) {
+		Process& process = mProcesses[ frameType ];
 		switch( (FrameType)frameType ) {
 		case FrameType_Audio:
 			process.mThreadCallback = [ & ]()
 			{
-				while ( process.mRunning ) {
-					if ( process.mNewData || mKinect == KCB_INVALID_HANDLE || mEventHandlerAudio == nullptr  ) {
-						this_thread::sleep_for( chrono::milliseconds( kThreadSleepDuration ) );
-						continue;
-					}
-
+				while ( process.wait() ) {
 					if ( KCBIsFrameReady( mKinect, FrameSourceTypes_Audio ) ) {
 						AudioFrame frame;
 						WAVEFORMATEX format;
@@ -1190,17 +991,17 @@ void Device::start()
 								frame.mBeamAngleConfidence	= audioFrame->fBeamAngleConfidence;
 								frame.mBufferSize			= audioFrame->ulBytesRead;
 								if ( audioFrame->ulBytesRead > 0 ) {
-									frame.mBuffer			= new uint8_t[ frame.mBufferSize ];
-									memcpy( frame.mBuffer, audioFrame->pAudioBuffer, frame.mBufferSize );
+									frame.mBuffer			= shared_ptr<uint8_t>( new uint8_t[ frame.mBufferSize ], default_delete<uint8_t[]>() );
+									memcpy( frame.mBuffer.get(), audioFrame->pAudioBuffer, frame.mBufferSize );
 								}
 							}
 							delete [] audioFrame->pAudioBuffer;
 							delete audioFrame;
 						}
 
-						if ( frame.getTimeStamp() > mFrameAudio.getTimeStamp() ) {
-							mFrameAudio			= frame;
-							process.mNewData	= true;
+						if ( frame.getTimeStamp() > process.mTimeStamp ) {
+							process.mTimeStamp = frame.getTimeStamp();
+							process.produced( mFrameAudio.write( move( frame ) ) );
 						}
 					}
 				}
@@ -1209,12 +1010,7 @@ void Device::start()
 		case FrameType_Body:
 			process.mThreadCallback = [ & ]()
 			{
-				while ( process.mRunning ) {
-					if ( process.mNewData || mKinect == KCB_INVALID_HANDLE || mEventHandlerBody == nullptr ) {
-						this_thread::sleep_for( chrono::milliseconds( kThreadSleepDuration ) );
-						continue;
-					}
-
+				while ( process.wait() ) {
 					if ( KCBIsFrameReady( mKinect, FrameSourceTypes_Body ) ) {		
 						BodyFrame frame;
 						int64_t timeStamp					= 0L;
@@ -1222,6 +1018,9 @@ void Device::start()
 
 						long hr = KCBGetBodyData( mKinect, BODY_COUNT, kinectBodies, &timeStamp );
 						if ( SUCCEEDED( hr ) ) {
+							const uint32_t features		= mBodyFeatures;
+							const uint32_t jointMask	= ( features & BodyFeature_Joints ) != 0 ? (uint32_t)mBodyJointMask : 0u;
+							frame.mBodies.reserve( BODY_COUNT );
 							for ( uint8_t i = 0; i < BODY_COUNT; ++i ) {
 								IBody* kinectBody = kinectBodies[ i ];
 								if ( kinectBody != nullptr ) {
@@ -1232,130 +1031,50 @@ void Device::start()
 									if ( SUCCEEDED( hr ) && isTracked ) {
 										body.mTracked = true;
 
-										if ( mEnabledJointTracking ) {
+										kinectBody->get_Engaged( &body.mEngaged );
+										kinectBody->get_TrackingId( &body.mId );
+
+										if ( jointMask != 0 ) {
+											// The SDK only hands out the full joint set
 											Joint joints[ JointType_Count ];
 											kinectBody->GetJoints( JointType_Count, joints );
 
 											JointOrientation jointOrientations[ JointType_Count ];
-											kinectBody->GetJointOrientations( JointType_Count, jointOrientations );
+											const bool orientations = ( features & BodyFeature_JointOrientations ) != 0;
+											if ( orientations ) {
+												kinectBody->GetJointOrientations( JointType_Count, jointOrientations );
+											}
 
 											for ( int32_t j = 0; j < JointType_Count; ++j ) {
-												JointType parentJoint = (JointType)j;
-												switch ( (JointType)j ) {
-												case JointType::JointType_AnkleLeft:
-													parentJoint = JointType_KneeLeft;
-													break;
-												case JointType::JointType_AnkleRight:
-													parentJoint = JointType_KneeRight;
-													break;
-												case JointType::JointType_ElbowLeft:
-													parentJoint = JointType_ShoulderLeft;
-													break;
-												case JointType::JointType_ElbowRight:
-													parentJoint = JointType_ShoulderRight;
-													break;
-												case JointType::JointType_FootLeft:
-													parentJoint = JointType_AnkleLeft;
-													break;
-												case JointType::JointType_FootRight:
-													parentJoint = JointType_AnkleRight;
-													break;
-												case JointType::JointType_HandLeft:
-													parentJoint = JointType_WristLeft;
-													break;
-												case JointType::JointType_HandRight:
-													parentJoint = JointType_WristRight;
-													break;
-												case JointType::JointType_HandTipLeft:
-													parentJoint = JointType_HandLeft;
-													break;
-												case JointType::JointType_HandTipRight:
-													parentJoint = JointType_HandRight;
-													break;
-												case JointType::JointType_Head:
-													parentJoint = JointType_Neck;
-													break;
-												case JointType::JointType_HipLeft:
-													parentJoint = JointType_SpineBase;
-													break;
-												case JointType::JointType_HipRight:
-													parentJoint = JointType_SpineBase;
-													break;
-												case JointType::JointType_KneeLeft:
-													parentJoint = JointType_HipLeft;
-													break;
-												case JointType::JointType_KneeRight:
-													parentJoint = JointType_HipRight;
-													break;
-												case JointType::JointType_Neck:
-													parentJoint = JointType_SpineShoulder;
-													break;
-												case JointType::JointType_ShoulderLeft:
-													parentJoint = JointType_SpineShoulder;
-													break;
-												case JointType::JointType_ShoulderRight:
-													parentJoint = JointType_SpineShoulder;
-													break;
-												case JointType::JointType_SpineBase:
-													parentJoint = JointType_SpineBase;
-													break;
-												case JointType::JointType_SpineMid:
-													parentJoint = JointType_SpineBase;
-													break;
-												case JointType::JointType_SpineShoulder:
-													parentJoint = JointType_SpineMid;
-													break;
-												case JointType::JointType_ThumbLeft:
-													parentJoint = JointType_HandLeft;
-													break;
-												case JointType::JointType_ThumbRight:
-													parentJoint = JointType_HandRight;
-													break;
-												case JointType::JointType_WristLeft:
-													parentJoint = JointType_ElbowLeft;
-													break;
-												case JointType::JointType_WristRight:
-													parentJoint = JointType_ElbowRight;
-													break;
+												if ( ( jointMask & ( 1u << j ) ) != 0 ) {
+													body.mJointPositions[ j ]		= toVec3( joints[ j ].Position );
+													body.mJointTrackingStates[ j ]	= joints[ j ].TrackingState;
+													if ( orientations ) {
+														body.mJointOrientations[ j ] = toQuat( jointOrientations[ j ].Orientation );
+													}
 												}
-
-												Body::Joint joint( 
-													toVec3( joints[ j ].Position ), 
-													toQuat( jointOrientations[ j ].Orientation ), 
-													joints[ j ].TrackingState, 
-													parentJoint
-													);
-												body.mJointMap.insert( pair<JointType, Body::Joint>( static_cast<JointType>( j ), joint ) );
 											}
+											body.mJointMask = jointMask;
 										}
 										
-										PointF lean;
-										kinectBody->get_Engaged( &body.mEngaged );
-										kinectBody->get_Lean( &lean );
-										kinectBody->get_LeanTrackingState( &body.mLeanTrackingState );
-										kinectBody->get_TrackingId( &body.mId );
-
-										body.mLean = toVec2( lean );
+										if ( ( features & BodyFeature_Lean ) != 0 ) {
+											PointF lean;
+											kinectBody->get_Lean( &lean );
+											kinectBody->get_LeanTrackingState( &body.mLeanTrackingState );
+											body.mLean = toVec2( lean );
+										}
 										
-										DetectionResult activities[ Activity_Count ];
-										kinectBody->GetActivityDetectionResults( (UINT)Activity_Count, activities );
-										for ( size_t j = 0; j < (size_t)Activity_Count; ++j ) {
-											body.mActivities[ (Activity)j ] = activities[ j ];
+										if ( ( features & BodyFeature_Activities ) != 0 ) {
+											kinectBody->GetActivityDetectionResults( (UINT)Activity_Count, body.mActivities.data() );
 										}
-
-										DetectionResult appearances[ Appearance_Count ];
-										kinectBody->GetAppearanceDetectionResults( (UINT)Appearance_Count, appearances );
-										for ( size_t j = 0; j < (size_t)Appearance_Count; ++j ) {
-											body.mAppearances[ (Appearance)i ] = appearances[ j ];
+										if ( ( features & BodyFeature_Appearances ) != 0 ) {
+											kinectBody->GetAppearanceDetectionResults( (UINT)Appearance_Count, body.mAppearances.data() );
 										}
-
-										DetectionResult expressions[ Expression_Count ];
-										kinectBody->GetExpressionDetectionResults( (UINT)Expression_Count, expressions );
-										for ( size_t j = 0; j < (size_t)Expression_Count; ++j ) {
-											body.mExpressions[ (Expression)j ] = expressions[ j ];
+										if ( ( features & BodyFeature_Expressions ) != 0 ) {
+											kinectBody->GetExpressionDetectionResults( (UINT)Expression_Count, body.mExpressions.data() );
 										}
 
-										if ( mEnabledHandTracking ) {
+										if ( ( features & BodyFeature_Hands ) != 0 ) {
 											kinectBody->get_HandLeftConfidence( &body.mHands[ 0 ].mConfidence );
 											kinectBody->get_HandLeftState( &body.mHands[ 0 ].mState );
 											kinectBody->get_HandRightConfidence( &body.mHands[ 1 ].mConfidence );
@@ -1369,10 +1088,11 @@ void Device::start()
 								}
 							}
 							frame.mTimeStamp = static_cast<long long>( timeStamp );
+							frame.mArrivalTime = readArrivalClock();
 						}
-						if ( frame.getTimeStamp() > mFrameBody.getTimeStamp() ) {
-							mFrameBody			= frame;
-							process.mNewData	= true;
+						if ( frame.getTimeStamp() > process.mTimeStamp ) {
+							process.mTimeStamp = frame.getTimeStamp();
+							process.produced( mFrameBody.write( move( frame ) ) );
 						}
 					}
 				}
@@ -1381,12 +1101,7 @@ void Device::start()
 		case FrameType_BodyIndex:
 			process.mThreadCallback = [ & ]()
 			{
-				while ( process.mRunning ) {
-					if ( process.mNewData || mKinect == KCB_INVALID_HANDLE || mEventHandlerBodyIndex == nullptr ) {
-						this_thread::sleep_for( chrono::milliseconds( kThreadSleepDuration ) );
-						continue;
-					}
-
+				while ( process.wait() ) {
 					if ( KCBIsFrameReady( mKinect, FrameSourceTypes_BodyIndex ) ) {
 						BodyIndexFrame frame;
 						KCBFrameDescription frameDescription;
@@ -1400,13 +1115,19 @@ void Device::start()
 							if ( SUCCEEDED( hr ) ) {
 								hr = bodyIndexFrame->get_RelativeTime( &timeStamp );
 								if ( SUCCEEDED( hr ) ) {
-									frame.mTimeStamp	= static_cast<long long>( timeStamp );
 									int32_t h			= frameDescription.height;
 									int32_t w			= frameDescription.width;
-									frame.mChannel		= Channel8u::create( w, h );
-									uint32_t capacity	= (uint32_t)( w * h );
-									uint8_t* buffer		= frame.mChannel->getData();
-									bodyIndexFrame->CopyFrameDataToArray( capacity, buffer );
+									frame.mChannel		= mPoolBodyIndex.acquire( ivec2( w, h ), [ & ]()
+									{
+										return Channel8u::create( w, h );
+									} );
+									if ( frame.mChannel ) {
+										frame.mTimeStamp	= static_cast<long long>( timeStamp );
+										frame.mArrivalTime	= readArrivalClock();
+										uint32_t capacity	= (uint32_t)( w * h );
+										uint8_t* buffer		= frame.mChannel->getData();
+										bodyIndexFrame->CopyFrameDataToArray( capacity, buffer );
+									}
 								}
 							}
 							if ( bodyIndexFrame != nullptr ) {
@@ -1415,9 +1136,9 @@ void Device::start()
 							}
 						}
 
-						if ( frame.getTimeStamp() > mFrameBodyIndex.getTimeStamp() ) {
-							mFrameBodyIndex		= frame;
-							process.mNewData	= true;
+						if ( frame.getTimeStamp() > process.mTimeStamp ) {
+							process.mTimeStamp = frame.getTimeStamp();
+							process.produced( mFrameBodyIndex.write( move( frame ) ) );
 						}
 					}
 				}
@@ -1426,12 +1147,7 @@ void Device::start()
 		case FrameType_Color:
 			process.mThreadCallback = [ & ]()
 			{
-				while ( process.mRunning ) {
-					if ( process.mNewData || mKinect == KCB_INVALID_HANDLE || mEventHandlerColor == nullptr ) {
-						this_thread::sleep_for( chrono::milliseconds( kThreadSleepDuration ) );
-						continue;
-					}
-
+				while ( process.wait() ) {
 					if ( KCBIsFrameReady( mKinect, FrameSourceTypes_Color ) ) {
 						ColorFrame frame;
 						KCBFrameDescription frameDescription;
@@ -1448,11 +1164,17 @@ void Device::start()
 							if ( SUCCEEDED( hr ) ) {
 								hr = colorFrame->get_RelativeTime( &timeStamp );
 								if ( SUCCEEDED( hr ) ) {
-									frame.mTimeStamp	= static_cast<long long>( timeStamp );
-									frame.mSurface		= Surface8u::create( frame.getSize().x, frame.getSize().y, false, SurfaceChannelOrder::BGRA );
-									uint32_t capacity	= frame.getSize().x * frame.getSize().y * frameDescription.bytesPerPixel;
-									uint8_t* buffer		= frame.mSurface->getData();
-									colorFrame->CopyConvertedFrameDataToArray( capacity, buffer, ColorImageFormat_Bgra );
+									frame.mSurface		= mPoolColor.acquire( frame.getSize(), [ & ]()
+									{
+										return Surface8u::create( frame.getSize().x, frame.getSize().y, false, SurfaceChannelOrder::BGRA );
+									} );
+									if ( frame.mSurface ) {
+										frame.mTimeStamp	= static_cast<long long>( timeStamp );
+										frame.mArrivalTime	= readArrivalClock();
+										uint32_t capacity	= frame.getSize().x * frame.getSize().y * frameDescription.bytesPerPixel;
+										uint8_t* buffer		= frame.mSurface->getData();
+										colorFrame->CopyConvertedFrameDataToArray( capacity, buffer, ColorImageFormat_Bgra );
+									}
 								}
 							}
 							if ( colorFrame != nullptr ) {
@@ -1461,9 +1183,9 @@ void Device::start()
 							}
 						}
 
-						if ( frame.getTimeStamp() > mFrameColor.getTimeStamp() ) {
-							mFrameColor			= frame;
-							process.mNewData	= true;
+						if ( frame.getTimeStamp() > process.mTimeStamp ) {
+							process.mTimeStamp = frame.getTimeStamp();
+							process.produced( mFrameColor.write( move( frame ) ) );
 						}
 					}
 				}
@@ -1472,12 +1194,7 @@ void Device::start()
 		case FrameType_Depth:
 			process.mThreadCallback = [ & ]()
 			{
-				while ( process.mRunning ) {
-					if ( process.mNewData || mKinect == KCB_INVALID_HANDLE || mEventHandlerDepth == nullptr ) {
-						this_thread::sleep_for( chrono::milliseconds( kThreadSleepDuration ) );
-						continue;
-					}
-
+				while ( process.wait() ) {
 					if ( KCBIsFrameReady( mKinect, FrameSourceTypes_Depth ) ) {
 						DepthFrame frame;
 						KCBFrameDescription frameDescription;
@@ -1495,11 +1212,17 @@ void Device::start()
 							if ( SUCCEEDED( hr ) ) {
 								hr = depthFrame->get_RelativeTime( &timeStamp );
 								if ( SUCCEEDED( hr ) ) {
-									frame.mTimeStamp	= static_cast<long long>( timeStamp );
-									frame.mChannel		= Channel16u::create( frame.getSize().x, frame.getSize().y );
-									uint32_t capacity	= frame.getSize().x * frame.getSize().y;
-									uint16_t* buffer	= frame.mChannel->getData();
-									depthFrame->CopyFrameDataToArray( capacity, buffer );
+									frame.mChannel		= mPoolDepth.acquire( frame.getSize(), [ & ]()
+									{
+										return Channel16u::create( frame.getSize().x, frame.getSize().y );
+									} );
+									if ( frame.mChannel ) {
+										frame.mTimeStamp	= static_cast<long long>( timeStamp );
+										frame.mArrivalTime	= readArrivalClock();
+										uint32_t capacity	= frame.getSize().x * frame.getSize().y;
+										uint16_t* buffer	= frame.mChannel->getData();
+										depthFrame->CopyFrameDataToArray( capacity, buffer );
+									}
 								}
 							}
 							if ( depthFrame != nullptr ) {
@@ -1508,9 +1231,9 @@ void Device::start()
 							}
 						}
 
-						if ( frame.getTimeStamp() > mFrameDepth.getTimeStamp() ) {
-							mFrameDepth			= frame;
-							process.mNewData	= true;
+						if ( frame.getTimeStamp() > process.mTimeStamp ) {
+							process.mTimeStamp = frame.getTimeStamp();
+							process.produced( mFrameDepth.write( move( frame ) ) );
 						}
 					}
 				}
@@ -1519,12 +1242,7 @@ void Device::start()
 		case FrameType_Face2d:
 			process.mThreadCallback = [ & ]()
 			{
-				while ( process.mRunning ) {
-					if ( process.mNewData || mKinect == KCB_INVALID_HANDLE || mEventHandlerFace2d == nullptr ) {
-						this_thread::sleep_for( chrono::milliseconds( kThreadSleepDuration ) );
-						continue;
-					}
-
+				while ( process.wait() ) {
 					if ( KCBIsFrameReady( mKinect, FrameSourceTypes_Body ) ) {		
 						Face2dFrame frame;
 						int64_t timeStamp					= 0L;
@@ -1618,11 +1336,12 @@ void Device::start()
 							}
 							if ( newFaces ) {
 								frame.mTimeStamp = static_cast<long long>( timeStamp );
+								frame.mArrivalTime = readArrivalClock();
 							}
 						}
-						if ( frame.getTimeStamp() > mFrameFace2d.getTimeStamp() ) {
-							mFrameFace2d		= frame;
-							process.mNewData	= true;
+						if ( frame.getTimeStamp() > process.mTimeStamp ) {
+							process.mTimeStamp = frame.getTimeStamp();
+							process.produced( mFrameFace2d.write( move( frame ) ) );
 						}
 					}
 				}
@@ -1631,12 +1350,7 @@ void Device::start()
 		case FrameType_Face3d:
 			process.mThreadCallback = [ & ]()
 			{
-				while ( process.mRunning ) {
-					if ( process.mNewData || mKinect == KCB_INVALID_HANDLE || mEventHandlerFace3d == nullptr ) {
-						this_thread::sleep_for( chrono::milliseconds( kThreadSleepDuration ) );
-						continue;
-					}
-
+				while ( process.wait() ) {
 					if ( KCBIsFrameReady( mKinect, FrameSourceTypes_Body ) ) {		
 						Face3dFrame frame;
 						int64_t timeStamp					= 0L;
@@ -1776,11 +1490,12 @@ void Device::start()
 							}
 							if ( newFaces ) {
 								frame.mTimeStamp = static_cast<long long>( timeStamp );
+								frame.mArrivalTime = readArrivalClock();
 							}
 						}
-						if ( frame.getTimeStamp() > mFrameFace3d.getTimeStamp() ) {
-							mFrameFace3d		= frame;
-							process.mNewData	= true;
+						if ( frame.getTimeStamp() > process.mTimeStamp ) {
+							process.mTimeStamp = frame.getTimeStamp();
+							process.produced( mFrameFace3d.write( move( frame ) ) );
 						}
 					}
 				}
@@ -1789,12 +1504,7 @@ void Device::start()
 		case FrameType_Infrared:
 			process.mThreadCallback = [ & ]()
 			{
-				while ( process.mRunning ) {
-					if ( process.mNewData || mKinect == KCB_INVALID_HANDLE || mEventHandlerInfrared == nullptr ) {
-						this_thread::sleep_for( chrono::milliseconds( kThreadSleepDuration ) );
-						continue;
-					}
-
+				while ( process.wait() ) {
 					if ( KCBIsFrameReady( mKinect, FrameSourceTypes_Infrared ) ) {
 						InfraredFrame frame;
 						KCBFrameDescription frameDescription;
@@ -1808,13 +1518,19 @@ void Device::start()
 							if ( SUCCEEDED( hr ) ) {
 								hr = infraredFrame->get_RelativeTime( &timeStamp );
 								if ( SUCCEEDED( hr ) ) {
-									frame.mTimeStamp	= static_cast<long long>( timeStamp );
 									int32_t h			= frameDescription.height;
 									int32_t w			= frameDescription.width;
-									frame.mChannel		= Channel16u::create( w, h );
-									uint32_t capacity	= (uint32_t)( w * h );
-									uint16_t* buffer	= frame.mChannel->getData();
-									infraredFrame->CopyFrameDataToArray( capacity, buffer );
+									frame.mChannel		= mPoolInfrared.acquire( ivec2( w, h ), [ & ]()
+									{
+										return Channel16u::create( w, h );
+									} );
+									if ( frame.mChannel ) {
+										frame.mTimeStamp	= static_cast<long long>( timeStamp );
+										frame.mArrivalTime	= readArrivalClock();
+										uint32_t capacity	= (uint32_t)( w * h );
+										uint16_t* buffer	= frame.mChannel->getData();
+										infraredFrame->CopyFrameDataToArray( capacity, buffer );
+									}
 								}
 							}
 							if ( infraredFrame != nullptr ) {
@@ -1823,9 +1539,9 @@ void Device::start()
 							}
 						}
 
-						if ( frame.getTimeStamp() > mFrameInfrared.getTimeStamp() ) {
-							mFrameInfrared		= frame;
-							process.mNewData	= true;
+						if ( frame.getTimeStamp() > process.mTimeStamp ) {
+							process.mTimeStamp = frame.getTimeStamp();
+							process.produced( mFrameInfrared.write( move( frame ) ) );
 						}
 					}
 				}
@@ -1834,12 +1550,7 @@ void Device::start()
 		case FrameType_InfraredLongExposure:
 			process.mThreadCallback = [ & ]()
 			{
-				while ( process.mRunning ) {
-					if ( process.mNewData || mKinect == KCB_INVALID_HANDLE || mEventHandlerInfraredLongExposure == nullptr ) {
-						this_thread::sleep_for( chrono::milliseconds( kThreadSleepDuration ) );
-						continue;
-					}
-
+				while ( process.wait() ) {
 					if ( KCBIsFrameReady( mKinect, FrameSourceTypes_LongExposureInfrared ) ) {
 						InfraredFrame frame;
 						KCBFrameDescription frameDescription;
@@ -1854,13 +1565,19 @@ void Device::start()
 							if ( SUCCEEDED( hr ) ) {
 								hr = infraredLongExposureFrame->get_RelativeTime( &timeStamp );
 								if ( SUCCEEDED( hr ) ) {
-									frame.mTimeStamp	= static_cast<long long>( timeStamp );
 									int32_t h			= frameDescription.height;
 									int32_t w			= frameDescription.width;
-									frame.mChannel		= Channel16u::create( w, h );
-									uint32_t capacity	= (uint32_t)( w * h );
-									uint16_t* buffer	= frame.mChannel->getData();
-									infraredLongExposureFrame->CopyFrameDataToArray( capacity, buffer );
+									frame.mChannel		= mPoolInfraredLongExposure.acquire( ivec2( w, h ), [ & ]()
+									{
+										return Channel16u::create( w, h );
+									} );
+									if ( frame.mChannel ) {
+										frame.mTimeStamp	= static_cast<long long>( timeStamp );
+										frame.mArrivalTime	= readArrivalClock();
+										uint32_t capacity	= (uint32_t)( w * h );
+										uint16_t* buffer	= frame.mChannel->getData();
+										infraredLongExposureFrame->CopyFrameDataToArray( capacity, buffer );
+									}
 								}
 							}
 							if ( infraredLongExposureFrame != nullptr ) {
@@ -1869,9 +1586,9 @@ void Device::start()
 							}
 						}
 
-						if ( frame.getTimeStamp() > mFrameInfraredLongExposure.getTimeStamp() ) {
-							mFrameInfraredLongExposure	= frame;
-							process.mNewData			= true;
+						if ( frame.getTimeStamp() > process.mTimeStamp ) {
+							process.mTimeStamp = frame.getTimeStamp();
+							process.produced( mFrameInfraredLongExposure.write( move( frame ) ) );
 						}
 					}
 				}
@@ -1884,6 +1601,11 @@ void Device::start()
 
 void Device::stop()
 {
+	// Join the capture threads before the sensor handle goes away
+	for ( Process& process : mProcesses ) {
+		process.stop();
+	}
+
 	if ( mKinect != KCB_INVALID_HANDLE ) {
 		long hr = KCBCloseSensor( &mKinect );
 		if ( FAILED( hr ) ) {
@@ -1892,72 +1614,70 @@ void Device::stop()
 			mKinect = KCB_INVALID_HANDLE;
 		}
 	}
-
-	for ( size_t i = (size_t)FrameType_Audio; i < (size_t)FrameType_InfraredLongExposure; ++i ) {
-		mProcesses.at( (FrameType)i ).stop();
-	}
 }
 
 void Device::update()
 {
-	for ( size_t i = (size_t)FrameType_Audio; i < (size_t)FrameType_InfraredLongExposure; ++i ) {
+	for ( size_t i = (size_t)FrameType_Audio; i < (size_t)FrameType_Count; ++i ) {
 		FrameType frameType	= (FrameType)i;
-		Process& process	= mProcesses.at( frameType );
+		Process& process	= mProcesses[ i ];
 		switch( frameType ) {
 		case FrameType_Audio:
-			if ( mEventHandlerAudio != nullptr && process.mNewData ) {
-				mEventHandlerAudio( mFrameAudio );
-				process.mNewData = false;
+			if ( mEventHandlerAudio != nullptr && mFrameAudio.readNew() ) {
+				++process.mNumFramesDelivered;
+				mEventHandlerAudio( mFrameAudio.read() );
 			}
 			break;
 		case FrameType_Body:
-			if ( mEventHandlerBody != nullptr && process.mNewData ) {
-				mEventHandlerBody( mFrameBody );
-				process.mNewData = false;
+			if ( mEventHandlerBody != nullptr && mFrameBody.readNew() ) {
+				++process.mNumFramesDelivered;
+				mEventHandlerBody( mFrameBody.read() );
 			}
 			break;
 		case FrameType_BodyIndex:
-			if ( mEventHandlerBodyIndex != nullptr && process.mNewData ) {
-				mEventHandlerBodyIndex( mFrameBodyIndex );
-				process.mNewData = false;
+			if ( mEventHandlerBodyIndex != nullptr && mFrameBodyIndex.readNew() ) {
+				++process.mNumFramesDelivered;
+				mEventHandlerBodyIndex( mFrameBodyIndex.read() );
 			}
 			break;
 		case FrameType_Color:
-			if ( mEventHandlerColor != nullptr && process.mNewData ) {
-				mEventHandlerColor( mFrameColor );
-				process.mNewData = false;
+			if ( mEventHandlerColor != nullptr && mFrameColor.readNew() ) {
+				++process.mNumFramesDelivered;
+				mEventHandlerColor( mFrameColor.read() );
 			}
 			break;
 		case FrameType_Depth:
-			if ( mEventHandlerDepth != nullptr && process.mNewData ) {
-				mEventHandlerDepth( mFrameDepth );
-				process.mNewData = false;
+			if ( mEventHandlerDepth != nullptr && mFrameDepth.readNew() ) {
+				++process.mNumFramesDelivered;
+				mEventHandlerDepth( mFrameDepth.read() );
 			}
 			break;
 		case FrameType_Face2d:
-			if ( mEventHandlerFace2d != nullptr && process.mNewData ) {
-				mEventHandlerFace2d( mFrameFace2d );
-				process.mNewData = false;
+			if ( mEventHandlerFace2d != nullptr && mFrameFace2d.readNew() ) {
+				++process.mNumFramesDelivered;
+				mEventHandlerFace2d( mFrameFace2d.read() );
 			}
 			break;
 		case FrameType_Face3d:
-			if ( mEventHandlerFace3d != nullptr && process.mNewData ) {
-				mEventHandlerFace3d( mFrameFace3d );
-				process.mNewData = false;
+			if ( mEventHandlerFace3d != nullptr && mFrameFace3d.readNew() ) {
+				++process.mNumFramesDelivered;
+				mEventHandlerFace3d( mFrameFace3d.read() );
 			}
 			break;
 		case FrameType_Infrared:
-			if ( mEventHandlerInfrared != nullptr && process.mNewData ) {
-				mEventHandlerInfrared( mFrameInfrared );
-				process.mNewData = false;
+			if ( mEventHandlerInfrared != nullptr && mFrameInfrared.readNew() ) {
+				++process.mNumFramesDelivered;
+				mEventHandlerInfrared( mFrameInfrared.read() );
 			}
 			break;
 		case FrameType_InfraredLongExposure:
-			if ( mEventHandlerInfraredLongExposure != nullptr && process.mNewData ) {
-				mEventHandlerInfraredLongExposure( mFrameInfraredLongExposure );
-				process.mNewData = false;
+			if ( mEventHandlerInfraredLongExposure != nullptr && mFrameInfraredLongExposure.readNew() ) {
+				++process.mNumFramesDelivered;
+				mEventHandlerInfraredLongExposure( mFrameInfraredLongExposure.read() );
 			}
 			break;
+		default:
+			break;
 		}
 	}
 
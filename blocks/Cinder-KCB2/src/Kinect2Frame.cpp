@@ -0,0 +1,519 @@
+/*
+* 
+* Copyright (c) 2015, Wieden+Kennedy
+* Stephen Schieberl
+* All rights reserved.
+* 
+* Redistribution and use in source and binary forms, with or 
+* without modification, are permitted provided that the following 
+* conditions are met:
+* 
+* Redistributions of source code must retain the above copyright 
+* notice, this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright 
+* notice, this list of conditions and the following disclaimer in 
+* the documentation and/or other materials provided with the 
+* distribution.
+* 
+* Neither the name of the Ban the Rewind nor the names of its 
+* contributors may be used to endorse or promote products 
+* derived from this software without specific prior written 
+* permission.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS 
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE 
+* COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, 
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+* STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF 
+* ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+*/
+
+#include "Kinect2Frame.h"
+#include <stdexcept>
+
+namespace Kinect2 {
+
+using namespace ci;
+using namespace std;
+
+Channel8uRef channel16To8( const Channel16uRef& channel, uint8_t bytes )
+{
+	Channel8uRef channel8;
+	if ( channel ) {
+		channel8 = Channel8u::create( channel->getWidth(), channel->getHeight() );
+		channel16To8( *channel, channel8->getData(), channel8->getRowBytes(), bytes );
+	}
+	return channel8;
+}
+
+void channel16To8( const Channel16u& channel, uint8_t* dst, size_t dstRowBytes, uint8_t bytes )
+{
+	Channel16u::ConstIter iter16 = channel.getIter();
+	for ( uint8_t* row = dst; iter16.line(); row += dstRowBytes ) {
+		uint8_t* pixel = row;
+		while ( iter16.pixel() ) {
+			*pixel++ = static_cast<uint8_t>( iter16.v() >> bytes );
+		}
+	}
+}
+
+Surface8uRef colorizeBodyIndex( const Channel8uRef& bodyIndexChannel )
+{
+	Surface8uRef surface;
+	if ( bodyIndexChannel ) {
+		surface = Surface8u::create( bodyIndexChannel->getWidth(), bodyIndexChannel->getHeight(), true, SurfaceChannelOrder::RGBA );
+		colorizeBodyIndex( *bodyIndexChannel, surface->getData(), surface->getRowBytes() );
+	}
+	return surface;
+}
+
+void colorizeBodyIndex( const Channel8u& bodyIndexChannel, uint8_t* dst, size_t dstRowBytes )
+{
+	// One lookup per index value rather than a switch per pixel.
+	uint8_t palette[ 256 ][ 4 ];
+	for ( size_t index = 0; index < 256; ++index ) {
+		const Color8u color	= getBodyColor( index );
+		palette[ index ][ 0 ]	= color.r;
+		palette[ index ][ 1 ]	= color.g;
+		palette[ index ][ 2 ]	= color.b;
+		palette[ index ][ 3 ]	= ( index == 0 || index > BODY_COUNT ) ? 0x00 : 0xFF;
+	}
+
+	Channel8u::ConstIter iterChannel = bodyIndexChannel.getIter();
+	for ( uint8_t* row = dst; iterChannel.line(); row += dstRowBytes ) {
+		uint8_t* pixel = row;
+		while ( iterChannel.pixel() ) {
+			const uint8_t* color = palette[ iterChannel.v() ];
+			pixel[ 0 ]	= color[ 0 ];
+			pixel[ 1 ]	= color[ 1 ];
+			pixel[ 2 ]	= color[ 2 ];
+			pixel[ 3 ]	= color[ 3 ];
+			pixel		+= 4;
+		}
+	}
+}
+
+Color8u getBodyColor( size_t index )
+{
+	switch ( index ) {
+	case 0:
+		return Color8u::black();
+	case 1:
+		return Color8u( 0xFF, 0x00, 0x00 );
+	case 2:
+		return Color8u( 0x00, 0xFF, 0x00 );
+	case 3:
+		return Color8u( 0x00, 0x00, 0xFF );
+	case 4:
+		return Color8u( 0xFF, 0xFF, 0x00 );
+	case 5:
+		return Color8u( 0x00, 0xFF, 0xFF );
+	case 6:
+		return Color8u( 0xFF, 0x00, 0xFF );
+	default:
+		return Color8u::white();
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+
+Body::Hand::Hand()
+: mConfidence( TrackingConfidence_Low ), mState( HandState_Unknown )
+{
+}
+
+TrackingConfidence Body::Hand::getConfidence() const
+{
+	return mConfidence;
+}
+
+HandState Body::Hand::getState() const
+{
+	return mState;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+
+Body::Joint::Joint()
+: mOrientation( quat() ), mParentJoint( JointType::JointType_Count ), mPosition( vec3( 0.0f ) ), 
+mTrackingState( TrackingState_NotTracked )
+{
+}
+
+Body::Joint::Joint( const vec3& position, const quat& orientation, TrackingState trackingState,
+	JointType parentJoint )
+: mOrientation( orientation ), mPosition( position ), mParentJoint( parentJoint ), 
+mTrackingState( trackingState )
+{
+}
+
+JointType Body::Joint::getParentJoint() const
+{
+	return mParentJoint;
+}
+
+const vec3& Body::Joint::getPosition() const
+{
+	return mPosition;
+}
+
+const quat& Body::Joint::getOrientation() const
+{
+	return mOrientation;
+}
+
+TrackingState Body::Joint::getTrackingState() const
+{
+	return mTrackingState;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+
+Body::JointMap::const_iterator::const_iterator( const Body* body, uint32_t index )
+: mBody( body ), mIndex( index )
+{
+	while ( mIndex < (uint32_t)JointType_Count && !mBody->hasJoint( (JointType)mIndex ) ) {
+		++mIndex;
+	}
+}
+
+Body::JointMap::value_type Body::JointMap::const_iterator::operator*() const
+{
+	const JointType jointType = (JointType)mIndex;
+	return value_type( jointType, Joint( mBody->mJointPositions[ mIndex ], mBody->mJointOrientations[ mIndex ], 
+		mBody->mJointTrackingStates[ mIndex ], Kinect2::getParentJoint( jointType ) ) );
+}
+
+Body::JointMap::const_iterator& Body::JointMap::const_iterator::operator++()
+{
+	*this = const_iterator( mBody, mIndex + 1 );
+	return *this;
+}
+
+bool Body::JointMap::const_iterator::operator==( const const_iterator& rhs ) const
+{
+	return mBody == rhs.mBody && mIndex == rhs.mIndex;
+}
+
+bool Body::JointMap::const_iterator::operator!=( const const_iterator& rhs ) const
+{
+	return !( *this == rhs );
+}
+
+Body::JointMap::JointMap( const Body* body )
+: mBody( body )
+{
+}
+
+Body::Joint Body::JointMap::at( JointType jointType ) const
+{
+	if ( !mBody->hasJoint( jointType ) ) {
+		throw out_of_range( "Body::JointMap::at" );
+	}
+	return ( *find( jointType ) ).second;
+}
+
+Body::JointMap::const_iterator Body::JointMap::begin() const
+{
+	return const_iterator( mBody, 0 );
+}
+
+size_t Body::JointMap::count( JointType jointType ) const
+{
+	return mBody->hasJoint( jointType ) ? 1 : 0;
+}
+
+bool Body::JointMap::empty() const
+{
+	return mBody->mJointMask == 0;
+}
+
+Body::JointMap::const_iterator Body::JointMap::end() const
+{
+	return const_iterator( mBody, (uint32_t)JointType_Count );
+}
+
+Body::JointMap::const_iterator Body::JointMap::find( JointType jointType ) const
+{
+	return mBody->hasJoint( jointType ) ? const_iterator( mBody, (uint32_t)jointType ) : end();
+}
+
+size_t Body::JointMap::size() const
+{
+	size_t n = 0;
+	for ( uint32_t mask = mBody->mJointMask; mask != 0; mask &= mask - 1 ) {
+		++n;
+	}
+	return n;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+
+Body::Body()
+: mEngaged( DetectionResult_Unknown ), mId( 0 ), mIndex( 0 ), 
+mLean( vec2( 0.0f ) ), mLeanTrackingState( TrackingState_NotTracked ), 
+mRestricted( false ), mTracked( false ), mJointMask( 0 )
+{
+	mActivities.fill( DetectionResult_Unknown );
+	mAppearances.fill( DetectionResult_Unknown );
+	mExpressions.fill( DetectionResult_Unknown );
+	for ( size_t i = 0; i < (size_t)JointType_Count; ++i ) {
+		mJointOrientations[ i ]		= quat();
+		mJointPositions[ i ]		= vec3( 0.0f );
+		mJointTrackingStates[ i ]	= TrackingState_NotTracked;
+	}
+}
+
+Body::Body( uint64_t id, uint8_t index )
+: Body()
+{
+	mId			= id;
+	mIndex		= index;
+	mTracked	= true;
+}
+
+float Body::calcConfidence( bool weighted ) const
+{
+	static const float kWeights[ JointType_Count ] = {
+		0.042553191f,	// SpineBase
+		0.042553191f,	// SpineMid
+		0.021276596f,	// Neck
+		0.042553191f,	// Head
+		0.021276596f,	// ShoulderLeft
+		0.010638298f,	// ElbowLeft
+		0.005319149f,	// WristLeft
+		0.042553191f,	// HandLeft
+		0.021276596f,	// ShoulderRight
+		0.010638298f,	// ElbowRight
+		0.005319149f,	// WristRight
+		0.042553191f,	// HandRight
+		0.021276596f,	// HipLeft
+		0.010638298f,	// KneeLeft
+		0.005319149f,	// AnkleLeft
+		0.042553191f,	// FootLeft
+		0.021276596f,	// HipRight
+		0.010638298f,	// KneeRight
+		0.005319149f,	// AnkleRight
+		0.042553191f,	// FootRight
+		0.002659574f,	// SpineShoulder
+		0.002659574f,	// HandTipLeft
+		0.002659574f,	// ThumbLeft
+		0.002659574f,	// HandTipRight
+		0.521276596f	// ThumbRight
+	};
+
+	float c = 0.0f;
+	for ( size_t i = 0; i < (size_t)JointType_Count; ++i ) {
+		if ( hasJoint( (JointType)i ) && mJointTrackingStates[ i ] == TrackingState::TrackingState_Tracked ) {
+			c += weighted ? kWeights[ i ] : 1.0f;
+		}
+	}
+	if ( !weighted ) {
+		c /= (float)JointType::JointType_Count;
+	}
+	return c;
+}
+
+const Body::ActivityArray& Body::getActivities() const
+{
+	return mActivities;
+}
+
+const Body::AppearanceArray& Body::getAppearances() const
+{
+	return mAppearances;
+}
+
+const Body::ExpressionArray& Body::getExpressions() const
+{
+	return mExpressions;
+}
+
+const Body::Hand& Body::getHandLeft() const
+{
+	return mHands[ 0 ];
+}
+
+const Body::Hand& Body::getHandRight() const
+{
+	return mHands[ 1 ];
+}
+
+uint64_t Body::getId() const 
+{ 
+	return mId; 
+}
+
+uint8_t Body::getIndex() const 
+{ 
+	return mIndex; 
+}
+
+bool Body::hasJoint( JointType jointType ) const
+{
+	return jointType < JointType_Count && ( mJointMask & ( 1u << jointType ) ) != 0;
+}
+
+const quat& Body::getJointOrientation( JointType jointType ) const
+{
+	return mJointOrientations[ jointType ];
+}
+
+const vec3& Body::getJointPosition( JointType jointType ) const
+{
+	return mJointPositions[ jointType ];
+}
+
+TrackingState Body::getJointTrackingState( JointType jointType ) const
+{
+	return mJointTrackingStates[ jointType ];
+}
+
+Body::JointMap Body::getJointMap() const 
+{ 
+	return JointMap( this ); 
+}
+
+void Body::setJoint( JointType jointType, const vec3& position, const quat& orientation, TrackingState trackingState )
+{
+	if ( jointType < JointType_Count ) {
+		mJointMask							|= 1u << jointType;
+		mJointOrientations[ jointType ]		= orientation;
+		mJointPositions[ jointType ]		= position;
+		mJointTrackingStates[ jointType ]	= trackingState;
+	}
+}
+
+const vec2& Body::getLean() const
+{
+	return mLean;
+}
+
+TrackingState Body::getLeanTrackingState() const
+{
+	return mLeanTrackingState;
+}
+
+DetectionResult Body::isEngaged() const
+{
+	return mEngaged;
+}
+
+bool Body::isRestricted() const
+{
+	return mRestricted;
+}
+
+bool Body::isTracked() const 
+{ 
+	return mTracked; 
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+
+Frame::Frame()
+: mArrivalTime( 0L ), mTimeStamp( 0L )
+{
+}
+
+long long Frame::getArrivalTime() const
+{
+	return mArrivalTime;
+}
+
+long long Frame::getTimeStamp() const
+{
+	return mTimeStamp;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+
+CameraFrame::CameraFrame()
+: mFovDiagonal( 0.0f ), mFovHorizontal( 0.0f ), 
+mFovVertical( 0.0f ), mSize( ivec2( 0 ) )
+{
+}
+
+float CameraFrame::getFovDiagonal() const
+{
+	return mFovDiagonal;
+}
+
+float CameraFrame::getFovHorizontal() const
+{
+	return mFovHorizontal;
+}
+
+float CameraFrame::getFovVertical() const
+{
+	return mFovVertical;
+}
+
+const ivec2& CameraFrame::getSize() const
+{
+	return mSize;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+BodyFrame::BodyFrame()
+: Frame()
+{
+}
+
+BodyFrame::BodyFrame( long long timeStamp, const vector<Body>& bodies )
+: Frame(), mBodies( bodies )
+{
+	mTimeStamp = timeStamp;
+}
+
+const vector<Body>& BodyFrame::getBodies() const
+{
+	return mBodies;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+
+template<typename T> 
+ChannelFrameT<T>::ChannelFrameT()
+: Frame()
+{
+}
+
+template<typename T> 
+const std::shared_ptr<ChannelT<T> >& ChannelFrameT<T>::getChannel() const
+{
+	return mChannel;
+}
+
+template class ChannelFrameT<uint8_t>;
+template class ChannelFrameT<uint16_t>;
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+
+ColorFrame::ColorFrame()
+: CameraFrame(), Frame()
+{
+	mSize = ivec2( 1920, 1080 );
+}
+
+const Surface8uRef& ColorFrame::getSurface() const
+{
+	return mSurface;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+
+DepthFrame::DepthFrame()
+: CameraFrame(), ChannelFrame16u()
+{
+	mSize = ivec2( 512, 424 );
+}
+
+}
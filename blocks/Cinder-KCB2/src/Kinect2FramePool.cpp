@@ -0,0 +1,30 @@
+#include "Kinect2FramePool.h"
+
+namespace Kinect2 {
+
+FramePoolStats::FramePoolStats()
+: mCapacity( 0 ), mNumAllocated( 0 ), mNumInUse( 0 ), mNumExhausted( 0 )
+{
+}
+
+size_t FramePoolStats::getCapacity() const
+{
+	return mCapacity;
+}
+
+size_t FramePoolStats::getNumAllocated() const
+{
+	return mNumAllocated;
+}
+
+size_t FramePoolStats::getNumInUse() const
+{
+	return mNumInUse;
+}
+
+uint64_t FramePoolStats::getNumExhausted() const
+{
+	return mNumExhausted;
+}
+
+}
@@ -0,0 +1,662 @@
+#include "Kinect2Recording.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined( CINDER_MSW )
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Kinect2 {
+
+using namespace ci;
+using namespace std;
+
+// File layout:
+//   header	{ char magic[ 4 ], uint32 version, uint64 indexOffset, uint64 numRecords, uint64 reserved }
+//   records	{ uint8 type, varint zigzag time stamp delta, varint payloadSize, uint8 padding,
+//				  padding bytes, payload } with every payload 8-byte aligned
+//   index		RecordIndexEntry[ numRecords ], 8-byte aligned
+// The header's index offset is zero until the writer closes the file.
+static const char		kRecordingMagic[ 4 ]	= { 'K', '2', 'R', 'C' };
+static const uint32_t	kRecordingVersion		= 2;
+static const size_t		kHeaderSize				= 32;
+static const size_t		kPayloadAlignment		= 8;
+
+// Joint positions are stored in millimeters
+static const float		kPositionScale			= 1000.0f;
+static const float		kLeanScale				= 10000.0f;
+
+// Body payload flags
+static const uint8_t	kBodyTracked			= 1 << 0;
+static const uint8_t	kBodyRestricted			= 1 << 1;
+
+// Body payload sizes: the per-body fields up to and including the joint
+// tracking states, then position and orientation per joint present.
+static const size_t		kBodyHeaderSize			= 8 + 1 + 1 + 1 + 1 + 2 + 2 + 1 + 4 + 8;
+static const size_t		kJointSize				= 3 * 2 + 4;
+static const uint32_t	kJointMaskAll			= ( 1u << JointType_Count ) - 1u;
+
+template<typename T>
+static void appendValue( vector<uint8_t>& buffer, const T& value )
+{
+	const uint8_t* bytes = reinterpret_cast<const uint8_t*>( &value );
+	buffer.insert( buffer.end(), bytes, bytes + sizeof( T ) );
+}
+
+template<typename T>
+static T readValue( const uint8_t*& cursor )
+{
+	T value;
+	memcpy( &value, cursor, sizeof( T ) );
+	cursor += sizeof( T );
+	return value;
+}
+
+static size_t encodeVarint( uint64_t value, uint8_t* out )
+{
+	size_t n = 0;
+	while ( value >= 0x80 ) {
+		out[ n++ ]	= (uint8_t)( value | 0x80 );
+		value		>>= 7;
+	}
+	out[ n++ ] = (uint8_t)value;
+	return n;
+}
+
+static bool decodeVarint( const uint8_t*& cursor, const uint8_t* end, uint64_t& value )
+{
+	value = 0;
+	for ( uint32_t shift = 0; shift < 64 && cursor < end; shift += 7 ) {
+		const uint8_t b	= *cursor++;
+		value			|= (uint64_t)( b & 0x7f ) << shift;
+		if ( ( b & 0x80 ) == 0 ) {
+			return true;
+		}
+	}
+	return false;
+}
+
+static uint64_t zigzagEncode( int64_t v )
+{
+	return ( (uint64_t)v << 1 ) ^ (uint64_t)( v >> 63 );
+}
+
+static int64_t zigzagDecode( uint64_t v )
+{
+	return (int64_t)( v >> 1 ) ^ -(int64_t)( v & 1 );
+}
+
+static uint32_t bitCount( uint32_t v )
+{
+	uint32_t n = 0;
+	for ( ; v != 0; v &= v - 1 ) {
+		++n;
+	}
+	return n;
+}
+
+static int16_t quantize( float v, float scale )
+{
+	return (int16_t)std::clamp( lroundf( v * scale ), -32767L, 32767L );
+}
+
+// Smallest-three quaternion packing: 2 bits for the index of the largest
+// component, which is dropped, and 10 bits for each of the other three.
+static const float kQuatRange = 0.70710678f;
+
+static uint32_t packQuat( const quat& q )
+{
+	float c[ 4 ]	= { q.x, q.y, q.z, q.w };
+	uint32_t largest = 0;
+	for ( uint32_t i = 1; i < 4; ++i ) {
+		if ( fabsf( c[ i ] ) > fabsf( c[ largest ] ) ) {
+			largest = i;
+		}
+	}
+	const float sign	= c[ largest ] < 0.0f ? -1.0f : 1.0f;
+	uint32_t packed		= largest << 30;
+	uint32_t shift		= 20;
+	for ( uint32_t i = 0; i < 4; ++i ) {
+		if ( i != largest ) {
+			const float v	= std::clamp( c[ i ] * sign / kQuatRange, -1.0f, 1.0f );
+			packed			|= (uint32_t)lroundf( ( v * 0.5f + 0.5f ) * 1023.0f ) << shift;
+			shift			-= 10;
+		}
+	}
+	return packed;
+}
+
+static quat unpackQuat( uint32_t packed )
+{
+	const uint32_t largest	= packed >> 30;
+	float c[ 4 ]			= { 0.0f, 0.0f, 0.0f, 0.0f };
+	float sum				= 0.0f;
+	uint32_t shift			= 20;
+	for ( uint32_t i = 0; i < 4; ++i ) {
+		if ( i != largest ) {
+			const float v	= (float)( ( packed >> shift ) & 0x3ff ) / 1023.0f;
+			c[ i ]			= ( v * 2.0f - 1.0f ) * kQuatRange;
+			sum				+= c[ i ] * c[ i ];
+			shift			-= 10;
+		}
+	}
+	c[ largest ] = sqrtf( std::max( 0.0f, 1.0f - sum ) );
+	return quat( c[ 3 ], c[ 0 ], c[ 1 ], c[ 2 ] );
+}
+
+ExcRecordingOpenFailed::ExcRecordingOpenFailed( const fs::path& path )
+: ci::Exception( "Unable to open recording: " + path.string() )
+{
+}
+
+ExcRecordingInvalid::ExcRecordingInvalid( const fs::path& path )
+: ci::Exception( "Invalid recording: " + path.string() )
+{
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+
+//! Read-only, copy-on-write view of a whole file.
+class MappedFile
+{
+public:
+	MappedFile( const fs::path& path );
+	~MappedFile();
+
+	const uint8_t*										getData() const;
+	size_t												getSize() const;
+protected:
+	uint8_t*											mData;
+	size_t												mSize;
+#if defined( CINDER_MSW )
+	HANDLE												mFile;
+	HANDLE												mMapping;
+#endif
+};
+
+MappedFile::MappedFile( const fs::path& path )
+: mData( nullptr ), mSize( 0 )
+{
+#if defined( CINDER_MSW )
+	mFile = CreateFileW( path.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+		OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr );
+	LARGE_INTEGER size;
+	if ( mFile == INVALID_HANDLE_VALUE || !GetFileSizeEx( mFile, &size ) ) {
+		if ( mFile != INVALID_HANDLE_VALUE ) {
+			CloseHandle( mFile );
+		}
+		throw ExcRecordingOpenFailed( path );
+	}
+	mSize		= (size_t)size.QuadPart;
+	mMapping	= CreateFileMappingW( mFile, nullptr, PAGE_WRITECOPY, 0, 0, nullptr );
+	if ( mMapping != nullptr ) {
+		mData = (uint8_t*)MapViewOfFile( mMapping, FILE_MAP_COPY, 0, 0, 0 );
+	}
+	if ( mData == nullptr ) {
+		if ( mMapping != nullptr ) {
+			CloseHandle( mMapping );
+		}
+		CloseHandle( mFile );
+		throw ExcRecordingOpenFailed( path );
+	}
+#else
+	const int fd = open( path.string().c_str(), O_RDONLY );
+	struct stat st;
+	if ( fd < 0 || fstat( fd, &st ) != 0 || st.st_size == 0 ) {
+		if ( fd >= 0 ) {
+			close( fd );
+		}
+		throw ExcRecordingOpenFailed( path );
+	}
+	mSize		= (size_t)st.st_size;
+	void* data	= mmap( nullptr, mSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0 );
+	close( fd );
+	if ( data == MAP_FAILED ) {
+		throw ExcRecordingOpenFailed( path );
+	}
+	madvise( data, mSize, MADV_SEQUENTIAL );
+	mData = (uint8_t*)data;
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+#if defined( CINDER_MSW )
+	UnmapViewOfFile( mData );
+	CloseHandle( mMapping );
+	CloseHandle( mFile );
+#else
+	munmap( mData, mSize );
+#endif
+}
+
+const uint8_t* MappedFile::getData() const
+{
+	return mData;
+}
+
+size_t MappedFile::getSize() const
+{
+	return mSize;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+
+RecordingWriterRef RecordingWriter::create( const fs::path& path )
+{
+	return RecordingWriterRef( new RecordingWriter( path ) );
+}
+
+RecordingWriter::RecordingWriter( const fs::path& path )
+: mOffset( 0 ), mPrevTimeStamp( 0L )
+{
+	mStream.open( path.string(), ios::binary | ios::trunc );
+	if ( !mStream.is_open() ) {
+		throw ExcRecordingOpenFailed( path );
+	}
+	uint8_t header[ kHeaderSize ] = { 0 };
+	memcpy( header, kRecordingMagic, sizeof( kRecordingMagic ) );
+	memcpy( header + 4, &kRecordingVersion, sizeof( kRecordingVersion ) );
+	writeBytes( header, sizeof( header ) );
+}
+
+RecordingWriter::~RecordingWriter()
+{
+	const uint8_t padding[ kPayloadAlignment ] = { 0 };
+	writeBytes( padding, ( kPayloadAlignment - mOffset % kPayloadAlignment ) % kPayloadAlignment );
+
+	const uint64_t indexOffset	= mOffset;
+	const uint64_t numRecords	= mIndex.size();
+	writeBytes( mIndex.data(), mIndex.size() * sizeof( RecordIndexEntry ) );
+	mStream.seekp( 8 );
+	mStream.write( reinterpret_cast<const char*>( &indexOffset ), sizeof( indexOffset ) );
+	mStream.write( reinterpret_cast<const char*>( &numRecords ), sizeof( numRecords ) );
+	mStream.close();
+}
+
+size_t RecordingWriter::getNumRecords() const
+{
+	return mIndex.size();
+}
+
+uint64_t RecordingWriter::getNumBytesWritten() const
+{
+	return mOffset;
+}
+
+void RecordingWriter::writeBodyFrame( const BodyFrame& frame )
+{
+	mPayload.clear();
+	appendValue<uint8_t>( mPayload, (uint8_t)frame.getBodies().size() );
+	for ( const Body& body : frame.getBodies() ) {
+		uint8_t flags = 0;
+		flags |= body.isTracked() ? kBodyTracked : 0;
+		flags |= body.isRestricted() ? kBodyRestricted : 0;
+		appendValue<uint64_t>( mPayload, body.getId() );
+		appendValue<uint8_t>( mPayload, body.getIndex() );
+		appendValue<uint8_t>( mPayload, flags );
+		appendValue<uint8_t>( mPayload, (uint8_t)( body.getHandLeft().getState() | body.getHandLeft().getConfidence() << 4 ) );
+		appendValue<uint8_t>( mPayload, (uint8_t)( body.getHandRight().getState() | body.getHandRight().getConfidence() << 4 ) );
+		appendValue<int16_t>( mPayload, quantize( body.getLean().x, kLeanScale ) );
+		appendValue<int16_t>( mPayload, quantize( body.getLean().y, kLeanScale ) );
+		appendValue<uint8_t>( mPayload, (uint8_t)body.getLeanTrackingState() );
+
+		// Joint presence mask followed by 2-bit tracking states. Parent
+		// joints are not stored, they follow from the joint type.
+		uint32_t mask	= 0;
+		uint64_t states	= 0;
+		for ( uint32_t j = 0; j < (uint32_t)JointType_Count; ++j ) {
+			if ( body.hasJoint( (JointType)j ) ) {
+				mask	|= 1u << j;
+				states	|= (uint64_t)( body.getJointTrackingState( (JointType)j ) & 0x3 ) << ( j * 2 );
+			}
+		}
+		appendValue<uint32_t>( mPayload, mask );
+		appendValue<uint64_t>( mPayload, states );
+		for ( uint32_t j = 0; j < (uint32_t)JointType_Count; ++j ) {
+			if ( ( mask & ( 1u << j ) ) != 0 ) {
+				const vec3& position = body.getJointPosition( (JointType)j );
+				appendValue<int16_t>( mPayload, quantize( position.x, kPositionScale ) );
+				appendValue<int16_t>( mPayload, quantize( position.y, kPositionScale ) );
+				appendValue<int16_t>( mPayload, quantize( position.z, kPositionScale ) );
+				appendValue<uint32_t>( mPayload, packQuat( body.getJointOrientation( (JointType)j ) ) );
+			}
+		}
+	}
+	writeRecord( RecordType_Body, frame.getTimeStamp(), mPayload.data(), mPayload.size() );
+}
+
+void RecordingWriter::writeBodyIndexFrame( const BodyIndexFrame& frame )
+{
+	writeChannel( RecordType_BodyIndex, frame );
+}
+
+void RecordingWriter::writeDepthFrame( const DepthFrame& frame )
+{
+	writeChannel( RecordType_Depth, frame );
+}
+
+template<typename T>
+void RecordingWriter::writeChannel( RecordType type, const ChannelFrameT<T>& frame )
+{
+	const std::shared_ptr<ChannelT<T> >& channel = frame.getChannel();
+	if ( !channel ) {
+		return;
+	}
+
+	// Rows are packed so the reader can wrap the pixels without copying
+	const int32_t w			= channel->getWidth();
+	const int32_t h			= channel->getHeight();
+	const size_t rowBytes	= w * sizeof( T );
+	mPayload.clear();
+	appendValue<int32_t>( mPayload, w );
+	appendValue<int32_t>( mPayload, h );
+	if ( channel->getRowBytes() == (ptrdiff_t)rowBytes ) {
+		const uint8_t* data = reinterpret_cast<const uint8_t*>( channel->getData() );
+		mPayload.insert( mPayload.end(), data, data + rowBytes * h );
+	} else {
+		for ( int32_t y = 0; y < h; ++y ) {
+			const uint8_t* row = reinterpret_cast<const uint8_t*>( channel->getData( ivec2( 0, y ) ) );
+			mPayload.insert( mPayload.end(), row, row + rowBytes );
+		}
+	}
+	writeRecord( type, frame.getTimeStamp(), mPayload.data(), mPayload.size() );
+}
+
+void RecordingWriter::writeRecord( RecordType type, long long timeStamp, const uint8_t* payload, size_t size )
+{
+	const long long delta	= mIndex.empty() ? timeStamp : timeStamp - mPrevTimeStamp;
+	mPrevTimeStamp			= timeStamp;
+
+	uint8_t header[ 32 ]	= { 0 };
+	size_t n				= 0;
+	header[ n++ ]			= (uint8_t)type;
+	n						+= encodeVarint( zigzagEncode( delta ), header + n );
+	n						+= encodeVarint( size, header + n );
+	const uint8_t padding	= (uint8_t)( ( kPayloadAlignment - ( mOffset + n + 1 ) % kPayloadAlignment ) % kPayloadAlignment );
+	header[ n++ ]			= padding;
+	n						+= padding;
+	writeBytes( header, n );
+
+	RecordIndexEntry entry	= {};
+	entry.mOffset			= mOffset;
+	entry.mTimeStamp		= timeStamp;
+	entry.mSize				= (uint32_t)size;
+	entry.mType				= (uint8_t)type;
+	mIndex.push_back( entry );
+
+	writeBytes( payload, size );
+}
+
+void RecordingWriter::writeBytes( const void* data, size_t size )
+{
+	mStream.write( reinterpret_cast<const char*>( data ), size );
+	mOffset += size;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+
+RecordingReaderRef RecordingReader::create( const fs::path& path )
+{
+	return RecordingReaderRef( new RecordingReader( path ) );
+}
+
+RecordingReader::RecordingReader( const fs::path& path )
+: mIndex( nullptr ), mNumRecords( 0 ), mPosition( 0 ), mOrdered( true ), mPath( path )
+{
+	mFile = make_shared<MappedFile>( path );
+
+	const uint8_t* data	= mFile->getData();
+	const size_t size	= mFile->getSize();
+	uint32_t version	= 0;
+	if ( size < kHeaderSize ) {
+		throw ExcRecordingInvalid( path );
+	}
+	memcpy( &version, data + 4, sizeof( version ) );
+	if ( memcmp( data, kRecordingMagic, sizeof( kRecordingMagic ) ) != 0 || version != kRecordingVersion ) {
+		throw ExcRecordingInvalid( path );
+	}
+
+	uint64_t indexOffset	= 0;
+	uint64_t numRecords		= 0;
+	memcpy( &indexOffset, data + 8, sizeof( indexOffset ) );
+	memcpy( &numRecords, data + 16, sizeof( numRecords ) );
+	if ( indexOffset == 0 ) {
+		buildIndex();
+	} else {
+		if ( indexOffset % kPayloadAlignment != 0 || indexOffset > size ||
+			numRecords > ( size - indexOffset ) / sizeof( RecordIndexEntry ) ) {
+			throw ExcRecordingInvalid( path );
+		}
+		mIndex		= reinterpret_cast<const RecordIndexEntry*>( data + indexOffset );
+		mNumRecords	= (size_t)numRecords;
+	}
+
+	// Every payload must lie inside the file, so records can be decoded
+	// straight from the mapping. A rebuilt index passes by construction.
+	for ( size_t i = 0; i < mNumRecords; ++i ) {
+		const RecordIndexEntry& entry = mIndex[ i ];
+		if ( entry.mType >= (uint8_t)RecordType_Count || entry.mOffset < kHeaderSize || 
+			entry.mOffset % kPayloadAlignment != 0 || entry.mOffset > size || entry.mSize > size - entry.mOffset ) {
+			throw ExcRecordingInvalid( path );
+		}
+		if ( i > 0 && entry.mTimeStamp < mIndex[ i - 1 ].mTimeStamp ) {
+			mOrdered = false;
+		}
+	}
+}
+
+RecordingReader::~RecordingReader()
+{
+}
+
+void RecordingReader::buildIndex()
+{
+	// The writer did not finish. Walk the records and drop a truncated tail.
+	const uint8_t* begin	= mFile->getData();
+	const uint8_t* end		= begin + mFile->getSize();
+	const uint8_t* cursor	= begin + kHeaderSize;
+	long long timeStamp		= 0L;
+	while ( cursor < end ) {
+		const uint8_t type	= *cursor++;
+		uint64_t delta		= 0;
+		uint64_t size		= 0;
+		if ( type >= (uint8_t)RecordType_Count ||
+			!decodeVarint( cursor, end, delta ) || !decodeVarint( cursor, end, size ) || cursor >= end ) {
+			break;
+		}
+		cursor += 1 + *cursor;
+		if ( cursor > end || size > (uint64_t)( end - cursor ) ) {
+			break;
+		}
+		timeStamp				= mRebuiltIndex.empty() ? zigzagDecode( delta ) : timeStamp + zigzagDecode( delta );
+		RecordIndexEntry entry	= {};
+		entry.mOffset			= (uint64_t)( cursor - begin );
+		entry.mTimeStamp		= timeStamp;
+		entry.mSize				= (uint32_t)size;
+		entry.mType				= type;
+		mRebuiltIndex.push_back( entry );
+		cursor += size;
+	}
+	mIndex		= mRebuiltIndex.data();
+	mNumRecords	= mRebuiltIndex.size();
+}
+
+bool RecordingReader::next()
+{
+	if ( mPosition >= mNumRecords ) {
+		return false;
+	}
+	++mPosition;
+	return true;
+}
+
+void RecordingReader::rewind()
+{
+	mPosition = 0;
+}
+
+void RecordingReader::seek( size_t index )
+{
+	mPosition = min( index, mNumRecords );
+}
+
+void RecordingReader::seekTime( long long timeStamp )
+{
+	const auto before = []( const RecordIndexEntry& entry, long long ts )
+	{
+		return entry.mTimeStamp < ts;
+	};
+	// Streams are interleaved in arrival order, so time stamps can step
+	// back between records of different types. Only a recording whose
+	// index is in time order can be searched.
+	const RecordIndexEntry* iter = nullptr;
+	if ( mOrdered ) {
+		iter = lower_bound( mIndex, mIndex + mNumRecords, timeStamp, before );
+	} else {
+		iter = find_if_not( mIndex, mIndex + mNumRecords, [ & ]( const RecordIndexEntry& entry )
+		{
+			return before( entry, timeStamp );
+		} );
+	}
+	mPosition = (size_t)( iter - mIndex );
+}
+
+size_t RecordingReader::getNumRecords() const
+{
+	return mNumRecords;
+}
+
+long long RecordingReader::getStartTimeStamp() const
+{
+	return mNumRecords > 0 ? mIndex[ 0 ].mTimeStamp : 0L;
+}
+
+long long RecordingReader::getEndTimeStamp() const
+{
+	return mNumRecords > 0 ? mIndex[ mNumRecords - 1 ].mTimeStamp : 0L;
+}
+
+RecordType RecordingReader::getRecordType() const
+{
+	return mPosition > 0 ? (RecordType)mIndex[ mPosition - 1 ].mType : RecordType_Count;
+}
+
+long long RecordingReader::getTimeStamp() const
+{
+	return mPosition > 0 ? mIndex[ mPosition - 1 ].mTimeStamp : 0L;
+}
+
+const uint8_t* RecordingReader::getPayload() const
+{
+	return mFile->getData() + mIndex[ mPosition - 1 ].mOffset;
+}
+
+size_t RecordingReader::getPayloadSize() const
+{
+	return mIndex[ mPosition - 1 ].mSize;
+}
+
+const BodyFrame& RecordingReader::getBodyFrame()
+{
+	if ( getRecordType() != RecordType_Body ) {
+		mBodyFrame.mTimeStamp = 0L;
+		mBodyFrame.mBodies.clear();
+		return mBodyFrame;
+	}
+
+	// Bodies are reused from the previous frame. Sizes are checked against
+	// the payload before each body and its joints are read.
+	const uint8_t* cursor	= getPayload();
+	const uint8_t* end		= cursor + getPayloadSize();
+	if ( cursor == end ) {
+		throw ExcRecordingInvalid( mPath );
+	}
+	const uint8_t count		= readValue<uint8_t>( cursor );
+	mBodyFrame.mTimeStamp	= getTimeStamp();
+	mBodyFrame.mBodies.resize( count );
+	for ( Body& body : mBodyFrame.mBodies ) {
+		if ( (size_t)( end - cursor ) < kBodyHeaderSize ) {
+			throw ExcRecordingInvalid( mPath );
+		}
+		body.mId								= readValue<uint64_t>( cursor );
+		body.mIndex								= readValue<uint8_t>( cursor );
+		const uint8_t flags						= readValue<uint8_t>( cursor );
+		body.mTracked							= ( flags & kBodyTracked ) != 0;
+		body.mRestricted						= ( flags & kBodyRestricted ) != 0;
+		for ( size_t i = 0; i < 2; ++i ) {
+			const uint8_t hand					= readValue<uint8_t>( cursor );
+			body.mHands[ i ].mState				= (HandState)( hand & 0xf );
+			body.mHands[ i ].mConfidence		= (TrackingConfidence)( hand >> 4 );
+		}
+		body.mLean.x							= (float)readValue<int16_t>( cursor ) / kLeanScale;
+		body.mLean.y							= (float)readValue<int16_t>( cursor ) / kLeanScale;
+		body.mLeanTrackingState					= (TrackingState)readValue<uint8_t>( cursor );
+
+		body.mJointMask							= readValue<uint32_t>( cursor ) & kJointMaskAll;
+		const uint64_t states					= readValue<uint64_t>( cursor );
+		if ( (size_t)( end - cursor ) < (size_t)bitCount( body.mJointMask ) * kJointSize ) {
+			throw ExcRecordingInvalid( mPath );
+		}
+		for ( uint32_t j = 0; j < (uint32_t)JointType_Count; ++j ) {
+			if ( ( body.mJointMask & ( 1u << j ) ) == 0 ) {
+				body.mJointTrackingStates[ j ] = TrackingState_NotTracked;
+				continue;
+			}
+			vec3& position					= body.mJointPositions[ j ];
+			position.x						= (float)readValue<int16_t>( cursor ) / kPositionScale;
+			position.y						= (float)readValue<int16_t>( cursor ) / kPositionScale;
+			position.z						= (float)readValue<int16_t>( cursor ) / kPositionScale;
+			body.mJointOrientations[ j ]	= unpackQuat( readValue<uint32_t>( cursor ) );
+			body.mJointTrackingStates[ j ]	= (TrackingState)( ( states >> ( j * 2 ) ) & 0x3 );
+		}
+	}
+	return mBodyFrame;
+}
+
+BodyIndexFrame RecordingReader::getBodyIndexFrame() const
+{
+	BodyIndexFrame frame;
+	if ( getRecordType() == RecordType_BodyIndex ) {
+		readChannel( frame );
+	}
+	return frame;
+}
+
+DepthFrame RecordingReader::getDepthFrame() const
+{
+	DepthFrame frame;
+	if ( getRecordType() == RecordType_Depth ) {
+		readChannel( frame );
+		frame.mSize = frame.mChannel->getSize();
+	}
+	return frame;
+}
+
+template<typename T>
+void RecordingReader::readChannel( ChannelFrameT<T>& frame ) const
+{
+	// The channel aliases the mapping and keeps it open for as long as the
+	// frame is held. Writes go to private copy-on-write pages.
+	const uint8_t* cursor	= getPayload();
+	const size_t size		= getPayloadSize();
+	if ( size < 2 * sizeof( int32_t ) ) {
+		throw ExcRecordingInvalid( mPath );
+	}
+	const int32_t w			= readValue<int32_t>( cursor );
+	const int32_t h			= readValue<int32_t>( cursor );
+	if ( w < 0 || h < 0 || (uint64_t)w * (uint64_t)h * sizeof( T ) > size - 2 * sizeof( int32_t ) ) {
+		throw ExcRecordingInvalid( mPath );
+	}
+	T* data					= reinterpret_cast<T*>( const_cast<uint8_t*>( cursor ) );
+	frame.mTimeStamp		= getTimeStamp();
+	frame.mChannel			= ChannelT<T>::create( w, h, w * sizeof( T ), 1, data, std::shared_ptr<T>( mFile, data ) );
+}
+
+}
@@ -0,0 +1,188 @@
+#include "Kinect2Replay.h"
+#include "cinder/app/App.h"
+
+namespace Kinect2 {
+
+using namespace ci;
+using namespace app;
+using namespace std;
+
+// Sensor time stamps are in 100 ns ticks
+static const long long kTicksPerMicrosecond = 10L;
+
+ReplayRef Replay::create( const fs::path& path, bool realTime, bool loop )
+{
+	return ReplayRef( new Replay( path, realTime, loop ) );
+}
+
+Replay::Replay( const fs::path& path, bool realTime, bool loop )
+: mEventHandlerBody( nullptr ), mEventHandlerBodyIndex( nullptr ), mEventHandlerDepth( nullptr ),
+mEnabledLoop( loop ), mEnabledRealTime( realTime ), mFinished( false ),
+mPending( false ), mRunning( false ), mNumBodyFramesDelivered( 0 ), mTimeStampOrigin( -1L )
+{
+	mReader				= RecordingReader::create( path );
+	mUpdateConnection	= App::get()->getSignalUpdate().connect( bind( &Replay::update, this ) );
+}
+
+Replay::~Replay()
+{
+	stop();
+	mUpdateConnection.disconnect();
+}
+
+void Replay::start()
+{
+	mReader->rewind();
+	mFinished			= false;
+	mPending			= false;
+	mRunning			= true;
+	mTimeStampOrigin	= -1L;
+	mTimeOrigin			= chrono::steady_clock::now();
+}
+
+void Replay::stop()
+{
+	mRunning = false;
+}
+
+void Replay::connectBodyEventHandler( const function<void ( const BodyFrame& )>& eventHandler )
+{
+	mEventHandlerBody = eventHandler;
+}
+
+void Replay::connectBodyIndexEventHandler( const function<void ( const BodyIndexFrame& )>& eventHandler )
+{
+	mEventHandlerBodyIndex = eventHandler;
+}
+
+void Replay::connectDepthEventHandler( const function<void ( const DepthFrame& )>& eventHandler )
+{
+	mEventHandlerDepth = eventHandler;
+}
+
+void Replay::enableLoop( bool enable )
+{
+	mEnabledLoop = enable;
+}
+
+void Replay::enableRealTime( bool enable )
+{
+	mEnabledRealTime	= enable;
+	mTimeStampOrigin	= -1L;
+}
+
+bool Replay::isFinished() const
+{
+	return mFinished;
+}
+
+bool Replay::isLoopEnabled() const
+{
+	return mEnabledLoop;
+}
+
+bool Replay::isRealTimeEnabled() const
+{
+	return mEnabledRealTime;
+}
+
+size_t Replay::getNumBodyFramesDelivered() const
+{
+	return mNumBodyFramesDelivered;
+}
+
+void Replay::update()
+{
+	if ( !mRunning || mFinished ) {
+		return;
+	}
+
+	if ( !mEnabledRealTime ) {
+		while ( mPending || readNext() ) {
+			const bool isBody = mReader->getRecordType() == RecordType_Body;
+			deliver();
+			if ( isBody ) {
+				break;
+			}
+		}
+		return;
+	}
+
+	const chrono::steady_clock::time_point origin = mTimeOrigin;
+	const long long elapsed = chrono::duration_cast<chrono::microseconds>(
+		chrono::steady_clock::now() - mTimeOrigin ).count() * kTicksPerMicrosecond;
+	while ( mPending || readNext() ) {
+		// A rewind restarts the clock, so the new pass starts on the next
+		// tick rather than being measured against this tick's elapsed time.
+		if ( mTimeOrigin != origin || mReader->getTimeStamp() - mTimeStampOrigin > elapsed ) {
+			break;
+		}
+		deliver();
+	}
+}
+
+bool Replay::readNext()
+{
+	if ( !mReader->next() ) {
+		if ( !mEnabledLoop ) {
+			mFinished = true;
+			return false;
+		}
+		mReader->rewind();
+		mTimeStampOrigin = -1L;
+		if ( !mReader->next() ) {
+			mFinished = true;
+			return false;
+		}
+	}
+	if ( mTimeStampOrigin < 0L ) {
+		mTimeStampOrigin	= mReader->getTimeStamp();
+		mTimeOrigin			= chrono::steady_clock::now();
+	}
+	mPending = true;
+	return true;
+}
+
+void Replay::deliver()
+{
+	mPending = false;
+
+	// In real time a frame is due at its time stamp and is stamped as having
+	// arrived then, however late the update that delivers it runs.
+	long long arrivalTime = readArrivalClock();
+	if ( mEnabledRealTime ) {
+		const long long due		= ( mReader->getTimeStamp() - mTimeStampOrigin ) / kTicksPerMicrosecond;
+		const long long elapsed	= chrono::duration_cast<chrono::microseconds>( chrono::steady_clock::now() - mTimeOrigin ).count();
+		arrivalTime -= std::max( 0LL, elapsed - due );
+	}
+
+	switch ( mReader->getRecordType() ) {
+	case RecordType_Body:
+		if ( mEventHandlerBody != nullptr ) {
+			// Copied into storage kept across frames, so no allocation once warm.
+			mBodyFrame				= mReader->getBodyFrame();
+			mBodyFrame.mArrivalTime	= arrivalTime;
+			mEventHandlerBody( mBodyFrame );
+		}
+		++mNumBodyFramesDelivered;
+		break;
+	case RecordType_BodyIndex:
+		if ( mEventHandlerBodyIndex != nullptr ) {
+			BodyIndexFrame frame	= mReader->getBodyIndexFrame();
+			frame.mArrivalTime		= arrivalTime;
+			mEventHandlerBodyIndex( frame );
+		}
+		break;
+	case RecordType_Depth:
+		if ( mEventHandlerDepth != nullptr ) {
+			DepthFrame frame	= mReader->getDepthFrame();
+			frame.mArrivalTime	= arrivalTime;
+			mEventHandlerDepth( frame );
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+}
@@ -0,0 +1,42 @@
+#include "Kinect2Source.h"
+#include <chrono>
+
+namespace Kinect2 {
+
+using namespace ci;
+
+static const float kDepthFocalLength	= 366.1f;
+static const vec2 kDepthPrincipalPoint	= vec2( 256.0f, 212.0f );
+
+Source::Source()
+{
+}
+
+Source::~Source()
+{
+}
+
+void Source::setArrivalClock( const std::function<long long ()>& clock )
+{
+	mArrivalClock = clock;
+}
+
+long long Source::readArrivalClock() const
+{
+	if ( mArrivalClock != nullptr ) {
+		return mArrivalClock();
+	}
+	return std::chrono::duration_cast<std::chrono::microseconds>( std::chrono::steady_clock::now().time_since_epoch() ).count();
+}
+
+ivec2 Source::mapCameraToDepth( const vec3& v ) const
+{
+	if ( v.z <= 0.0f ) {
+		return ivec2( 0 );
+	}
+	vec2 p( kDepthPrincipalPoint.x + kDepthFocalLength * v.x / v.z,
+			kDepthPrincipalPoint.y - kDepthFocalLength * v.y / v.z );
+	return ivec2( p );
+}
+
+}
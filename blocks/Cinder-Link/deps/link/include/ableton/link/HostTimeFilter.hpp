@@ -20,6 +20,7 @@
 #pragma once
 
 #include <ableton/link/LinearRegression.hpp>
+#include <cassert>
 #include <chrono>
 #include <cmath>
 #include <utility>
@@ -82,5 +83,129 @@ private:
 template <typename Clock>
 using HostTimeFilter = BasicHostTimeFilter<Clock, double, 512>;
 
+// Same fit as BasicHostTimeFilter, but the regression sums are updated as
+// points enter and leave the window instead of being recomputed, so adding
+// a point and mapping a time are both O(1). The sums are kept relative to
+// an origin that is moved to the window's mean once per kNumPoints
+// updates, which keeps them small however far the clocks have run.
+template <typename Clock, typename NumberType, std::size_t kNumPoints = 512>
+class BasicIncrementalHostTimeFilter
+{
+  using Point = std::pair<NumberType, NumberType>;
+  using Points = std::vector<Point>;
+
+public:
+  BasicIncrementalHostTimeFilter()
+  {
+    mPoints.reserve(kNumPoints);
+    reset();
+  }
+
+  ~BasicIncrementalHostTimeFilter() = default;
+
+  void reset()
+  {
+    mIndex = 0;
+    mPoints.clear();
+    mOrigin = std::make_pair(NumberType{0}, NumberType{0});
+    mSumX = NumberType{0};
+    mSumY = NumberType{0};
+    mSumXX = NumberType{0};
+    mSumXY = NumberType{0};
+  }
+
+  std::chrono::microseconds sampleTimeToHostTime(const NumberType sampleTime)
+  {
+    const auto micros = static_cast<NumberType>(mHostTimeSampler.micros().count());
+    addPoint(std::make_pair(sampleTime, micros));
+    return hostTimeAtSampleTime(sampleTime);
+  }
+
+  // Adds a point with the host time given rather than read from the clock.
+  void addSample(const NumberType sampleTime, const std::chrono::microseconds hostTime)
+  {
+    addPoint(std::make_pair(sampleTime, static_cast<NumberType>(hostTime.count())));
+  }
+
+  // Maps sampleTime with the current fit, without adding a point. Needs at
+  // least one point.
+  std::chrono::microseconds hostTimeAtSampleTime(const NumberType sampleTime) const
+  {
+    assert(!mPoints.empty());
+    const auto numPoints = static_cast<NumberType>(mPoints.size());
+    const auto meanX = mSumX / numPoints;
+    const auto meanY = mSumY / numPoints;
+    const auto varianceX = mSumXX - mSumX * meanX;
+    const auto slope =
+      varianceX == NumberType{0} ? NumberType{0} : (mSumXY - mSumX * meanY) / varianceX;
+    const auto hostTime =
+      mOrigin.second + meanY + slope * ((sampleTime - mOrigin.first) - meanX);
+    return std::chrono::microseconds(llround(hostTime));
+  }
+
+private:
+  void addPoint(const Point& point)
+  {
+    if (mPoints.empty())
+    {
+      mOrigin = point;
+    }
+
+    if (mPoints.size() < kNumPoints)
+    {
+      mPoints.push_back(point);
+    }
+    else
+    {
+      accumulate(mPoints[mIndex], NumberType{-1});
+      mPoints[mIndex] = point;
+    }
+    accumulate(point, NumberType{1});
+    mIndex = (mIndex + 1) % kNumPoints;
+
+    if (mIndex == 0)
+    {
+      recenter();
+    }
+  }
+
+  void accumulate(const Point& point, const NumberType sign)
+  {
+    const auto x = point.first - mOrigin.first;
+    const auto y = point.second - mOrigin.second;
+    mSumX += sign * x;
+    mSumY += sign * y;
+    mSumXX += sign * x * x;
+    mSumXY += sign * x * y;
+  }
+
+  // Moves the origin to the mean, where the first order sums are zero and
+  // the second order ones are the central moments.
+  void recenter()
+  {
+    const auto numPoints = static_cast<NumberType>(mPoints.size());
+    const auto meanX = mSumX / numPoints;
+    const auto meanY = mSumY / numPoints;
+    mSumXX -= mSumX * meanX;
+    mSumXY -= mSumX * meanY;
+    mSumX = NumberType{0};
+    mSumY = NumberType{0};
+    mOrigin.first += meanX;
+    mOrigin.second += meanY;
+  }
+
+  std::size_t mIndex;
+  Points mPoints;
+  Point mOrigin;
+  NumberType mSumX;
+  NumberType mSumY;
+  NumberType mSumXX;
+  NumberType mSumXY;
+  Clock mHostTimeSampler;
+};
+
+template <typename Clock>
+using IncrementalHostTimeFilter = BasicIncrementalHostTimeFilter<Clock, double, 512>;
+
 } // namespace link
 } // namespace ableton
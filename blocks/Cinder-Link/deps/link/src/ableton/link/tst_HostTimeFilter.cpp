@@ -19,7 +19,11 @@
 
 #include <ableton/link/HostTimeFilter.hpp>
 #include <ableton/test/CatchWrapper.hpp>
+#include <algorithm>
 #include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
 
 namespace ableton
 {
@@ -43,6 +47,22 @@ struct MockClock
   std::chrono::microseconds time;
 };
 
+// A 30 Hz frame clock read about a day after boot, with a few hundred
+// microseconds of arrival jitter.
+struct JitteryClock
+{
+  std::chrono::microseconds micros()
+  {
+    const auto jitter = static_cast<std::int64_t>((count * 7919) % 401) - 200;
+    const auto current = std::chrono::microseconds(
+      INT64_C(86400000000) + count * INT64_C(33333) + jitter);
+    ++count;
+    return current;
+  }
+
+  std::int64_t count = 0;
+};
+
 TEST_CASE("HostTimeFilter")
 {
   using Filter = ableton::link::HostTimeFilter<MockClock>;
@@ -80,5 +100,120 @@ TEST_CASE("HostTimeFilter")
   }
 }
 
+TEST_CASE("IncrementalHostTimeFilter")
+{
+  using Filter = ableton::link::IncrementalHostTimeFilter<MockClock>;
+  Filter filter;
+
+  SECTION("OneValue")
+  {
+    const auto ht = filter.sampleTimeToHostTime(5);
+    CHECK(0 == ht.count());
+  }
+
+  SECTION("MultipleValues")
+  {
+    const auto numValues = 600;
+    auto ht = std::chrono::microseconds(0);
+
+    for (int i = 0; i <= numValues; ++i)
+    {
+      ht = filter.sampleTimeToHostTime(i);
+    }
+
+    CHECK(numValues == ht.count());
+  }
+
+  SECTION("Reset")
+  {
+    auto ht = filter.sampleTimeToHostTime(0);
+    ht = filter.sampleTimeToHostTime(-230);
+    ht = filter.sampleTimeToHostTime(40);
+    REQUIRE(2 != ht.count());
+
+    filter.reset();
+    ht = filter.sampleTimeToHostTime(0);
+    CHECK(3 == ht.count());
+  }
+
+  SECTION("QueryDoesNotAddPoint")
+  {
+    filter.sampleTimeToHostTime(0);
+    filter.sampleTimeToHostTime(10);
+    const auto ht = filter.hostTimeAtSampleTime(20);
+    CHECK(2 == ht.count());
+    CHECK(2 == filter.sampleTimeToHostTime(20).count());
+  }
+
+  SECTION("SuppliedHostTime")
+  {
+    filter.addSample(0, std::chrono::microseconds(1000));
+    filter.addSample(10, std::chrono::microseconds(1020));
+    CHECK(1040 == filter.hostTimeAtSampleTime(20).count());
+  }
+}
+
+TEST_CASE("IncrementalHostTimeFilter | MatchesHostTimeFilter")
+{
+  using Reference = ableton::link::HostTimeFilter<JitteryClock>;
+  using Filter = ableton::link::IncrementalHostTimeFilter<JitteryClock>;
+
+  SECTION("NearZero")
+  {
+    Reference reference;
+    Filter filter;
+    auto maxDifference = std::int64_t{0};
+    for (std::int64_t i = 0; i < 2000; ++i)
+    {
+      const auto sampleTime = static_cast<double>(i) * 1600.0;
+      const auto expected = reference.sampleTimeToHostTime(sampleTime);
+      const auto actual = filter.sampleTimeToHostTime(sampleTime);
+      maxDifference = std::max(maxDifference, std::abs((actual - expected).count()));
+    }
+    CHECK(maxDifference <= 1);
+  }
+
+  SECTION("FarFromZero")
+  {
+    // Sensor ticks a day in, many times round the window. The plain sums
+    // lose precision here, so compare with a fit of the same window in
+    // long double about its own mean.
+    Filter filter;
+    JitteryClock clock;
+    std::vector<std::pair<long double, long double>> window;
+    auto maxDifference = std::int64_t{0};
+    for (std::int64_t i = 0; i < 20000; ++i)
+    {
+      const auto sampleTime = 864000000000.0 + static_cast<double>(i) * 333333.0;
+      const auto actual = filter.sampleTimeToHostTime(sampleTime);
+
+      window.emplace_back(sampleTime, clock.micros().count());
+      if (window.size() > 512)
+      {
+        window.erase(window.begin());
+      }
+      long double meanX = 0;
+      long double meanY = 0;
+      for (const auto& point : window)
+      {
+        meanX += point.first / window.size();
+        meanY += point.second / window.size();
+      }
+      long double sxx = 0;
+      long double sxy = 0;
+      for (const auto& point : window)
+      {
+        sxx += (point.first - meanX) * (point.first - meanX);
+        sxy += (point.first - meanX) * (point.second - meanY);
+      }
+      const auto slope = sxx == 0 ? 0 : sxy / sxx;
+      const auto expected =
+        static_cast<std::int64_t>(std::llround(meanY + slope * (sampleTime - meanX)));
+      maxDifference = std::max(maxDifference, std::abs(actual.count() - expected));
+    }
+    CHECK(maxDifference <= 1);
+  }
+}
+
 } // namespace link
 } // namespace ableton
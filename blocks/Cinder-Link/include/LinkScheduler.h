@@ -0,0 +1,111 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class LinkWrapper;
+
+//! Calls handlers on beat and phase boundaries of the Link session. A timer
+//! thread plans the next boundary on the current timeline, sleeps against
+//! the Link clock until just before it and spins the rest of the way, then
+//! hands the event to a dispatch thread through a lock-free queue, so slow
+//! handlers never delay the next boundary. The plan is redone at least every
+//! MaxSleep, which follows tempo and timeline changes. Sleeps are scaled by
+//! the measured rate of the clock, so an injected clock that runs fast,
+//! slow or not at all (LinkWrapper::setClock()) is followed too.
+class LinkScheduler
+{
+public:
+    struct Event
+    {
+        int handlerId{ 0 };
+        double beat{ 0.0 };
+        //! Host time the beat falls on.
+        std::chrono::microseconds hostTime{ 0 };
+        //! Host time the timer released it.
+        std::chrono::microseconds firedTime{ 0 };
+    };
+
+    typedef std::function<void( const Event & )> Handler;
+
+    //! The timer wakes this long before a boundary and spins to it.
+    static constexpr std::chrono::microseconds SpinTime{ 2000 };
+    //! Real time a spin may take before the clock is taken to have stalled.
+    static constexpr std::chrono::microseconds MaxSpin{ 2 * SpinTime };
+    static constexpr std::chrono::microseconds MaxSleep{ 20000 };
+    //! Shortest real time over which the clock rate is measured.
+    static constexpr std::chrono::microseconds RateInterval{ 10000 };
+    //! Events waiting for dispatch beyond this are dropped.
+    static constexpr uint32_t QueueSize = 256;
+
+    explicit LinkScheduler( LinkWrapper &link );
+    ~LinkScheduler();
+
+    LinkScheduler( const LinkScheduler & ) = delete;
+    LinkScheduler &operator=( const LinkScheduler & ) = delete;
+
+    //! Calls \a handler on the dispatch thread at every beat offset + k *
+    //! interval: an interval of the quantum is each downbeat, 0.25 each
+    //! 16th. Boundaries missed while the timeline jumps are skipped, not
+    //! caught up; one the clock steps just past is fired late. Returns an
+    //! id for removeHandler().
+    int addHandler( double interval, double offset, Handler handler );
+    //! Not from inside a handler.
+    void removeHandler( int id );
+
+    void start();
+    void stop();
+
+    uint64_t getNumDropped() const;
+
+private:
+    struct Subscription
+    {
+        int id;
+        double interval;
+        double offset;
+        //! Boundary planned next, and the last one fired.
+        double nextBeat;
+        double lastBeat;
+    };
+
+    void runTimer();
+    void runDispatch();
+    bool pushEvent( const Event &event );
+    bool popEvent( Event &event );
+
+    LinkWrapper &mLink;
+
+    // Timer side, guarded by mMutex.
+    std::vector<Subscription> mSubscriptions;
+    int mNextId{ 1 };
+    //! Written under mMutex; also read by the timer while it spins.
+    std::atomic<bool> mRunning{ false };
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+    std::thread mTimerThread;
+
+    // Dispatch side, guarded by mHandlerMutex.
+    std::vector<std::pair<int, Handler>> mHandlers;
+    std::mutex mHandlerMutex;
+    std::thread mDispatchThread;
+    std::atomic<bool> mDispatching{ false };
+    //! Bumped after each batch of events and on stop; the dispatch thread
+    //! waits on it.
+    std::atomic<uint32_t> mDispatchSignal{ 0 };
+
+    // Single producer (timer), single consumer (dispatch).
+    std::array<Event, QueueSize> mQueue;
+    std::atomic<uint32_t> mQueueHead{ 0 };
+    std::atomic<uint32_t> mQueueTail{ 0 };
+    std::atomic<uint64_t> mNumDropped{ 0 };
+};
+
+inline uint64_t LinkScheduler::getNumDropped() const { return mNumDropped.load( std::memory_order_relaxed ); }
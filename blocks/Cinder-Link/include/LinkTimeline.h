@@ -0,0 +1,90 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "LinkWrapper.h"
+
+//! One state of the session timeline, as stored in a timeline stream: the
+//! timeline line from hostTime on, and the sensor time of that instant so
+//! it lines up with a recording made alongside.
+struct LinkTimelineRecord
+{
+    int64_t hostTime{ 0 };
+    int64_t sensorTime{ 0 };
+    double tempo{ 120.0 };
+    double beat{ 0.0 };
+    double quantum{ 4.0 };
+    uint8_t isPlaying{ 0 };
+};
+
+typedef std::shared_ptr<class LinkTimelineRecorder> LinkTimelineRecorderRef;
+typedef std::shared_ptr<class LinkTimelinePlayer> LinkTimelinePlayerRef;
+
+//! Writes every tempo, beat-origin and start/stop change of a session to a
+//! timeline stream, meant to sit next to a sensor recording. Link's tempo
+//! and start/stop callbacks only note the change and when it happened in
+//! atomics, so they never block the Link thread; update() does the rest.
+//! Beat-origin changes have no callback and are found by comparing each
+//! snapshot with the last record.
+class LinkTimelineRecorder
+{
+public:
+    //! Throws std::runtime_error if \a path cannot be written.
+    static LinkTimelineRecorderRef create( LinkWrapper &link, const std::string &path );
+    ~LinkTimelineRecorder();
+
+    LinkTimelineRecorder( const LinkTimelineRecorder & ) = delete;
+    LinkTimelineRecorder &operator=( const LinkTimelineRecorder & ) = delete;
+
+    //! Call once per tick after LinkWrapper::captureSnapshot(). Nothing is
+    //! written until the first sensor frame has been added to \a link.
+    void update();
+
+    size_t getNumRecords() const;
+
+private:
+    LinkTimelineRecorder( LinkWrapper &link, const std::string &path );
+
+    void write( const LinkWrapper::Snapshot &snapshot );
+
+    LinkWrapper &mLink;
+    std::ofstream mStream;
+    //! Host time of the earliest change not yet written, or NoChange.
+    std::atomic<long long> mChangeTime;
+    bool mHasRecord{ false };
+    LinkWrapper::Snapshot mLastRecord;
+    size_t mNumRecords{ 0 };
+};
+
+//! Plays a timeline stream back as a LinkWrapper's virtual timeline,
+//! following the sensor time of a replay.
+class LinkTimelinePlayer
+{
+public:
+    //! Throws std::runtime_error if \a path is missing or not a timeline.
+    static LinkTimelinePlayerRef create( const std::string &path );
+
+    //! Sets \a link's timeline to the record in force at \a sensorTime,
+    //! mapped onto \a link's clock. Call as replayed frames arrive, after
+    //! LinkWrapper::addSensorTime(); jumping back is fine.
+    void update( LinkWrapper &link, long long sensorTime );
+
+    //! The record in force at \a sensorTime: the last at or before it, or
+    //! the first before any. Null if the stream has no records.
+    const LinkTimelineRecord *getRecordAt( long long sensorTime ) const;
+    const std::vector<LinkTimelineRecord> &getRecords() const;
+
+private:
+    explicit LinkTimelinePlayer( const std::string &path );
+
+    std::vector<LinkTimelineRecord> mRecords;
+    size_t mCurrent{ 0 };
+    bool mHasCurrent{ false };
+};
+
+inline size_t LinkTimelineRecorder::getNumRecords() const { return mNumRecords; }
+inline const std::vector<LinkTimelineRecord> &LinkTimelinePlayer::getRecords() const { return mRecords; }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <chrono>
 #include <functional>
 #include <memory>
 struct LinkState;
@@ -7,6 +8,26 @@ struct LinkState;
 class LinkWrapper
 {
 public:
+    //! The session timeline at one instant. Within a snapshot the timeline
+    //! is a straight line, so beats and phases at nearby times follow from
+    //! it without another capture.
+    struct Snapshot
+    {
+        std::chrono::microseconds hostTime{ 0 };
+        double tempo{ 120.0 };
+        double beat{ 0.0 };
+        double phase{ 0.0 };
+        double quantum{ 4.0 };
+        bool isPlaying{ false };
+
+        double beatAtTime( std::chrono::microseconds time ) const;
+        double phaseAtTime( std::chrono::microseconds time ) const;
+        std::chrono::microseconds timeAtBeat( double beat ) const;
+    };
+
+    //! A time source in microseconds, in place of the Link clock.
+    typedef std::function<std::chrono::microseconds()> Clock;
+
     LinkWrapper();
     ~LinkWrapper() = default;
     LinkWrapper( LinkWrapper &other ) = delete;
@@ -14,17 +35,73 @@ public:
     LinkWrapper( LinkWrapper &&other ) = delete;
     LinkWrapper &operator=( LinkWrapper &&rhs ) = delete;
 
+    //! Captures the app session state once; call at the start of each tick
+    //! and read getSnapshot() for the rest of it. App thread only.
+    const Snapshot &captureSnapshot();
+    const Snapshot &getSnapshot() const;
+    //! Snapshot from the audio session state, for capture and detection
+    //! threads. Real-time safe and callable from any number of threads:
+    //! one at a time captures and publishes, the others take the last
+    //! published timeline and carry it forward to now.
+    Snapshot captureRealtimeSnapshot() const;
+
+    //! Reads the time from \a clock instead of Link's, everywhere the
+    //! wrapper needs it; an empty clock restores Link's. Set it before
+    //! other threads use the wrapper.
+    void setClock( Clock clock );
+    //! Replaces the session with a virtual timeline: tempo, beats and
+    //! phases come from \a timeline, carried on from its host time, until
+    //! clearTimeline(). Together with a clock driven by recorded time
+    //! stamps, a replay gets the same beats however fast it runs.
+    void setTimeline( const Snapshot &timeline );
+    void clearTimeline();
+    bool hasTimeline() const;
+
     bool getIsEnabled() const;
     void setIsEnabled( bool state );
     double getBeat() const;
     double getPhase() const;
     double getBeatAndPhase( double &phase ) const;
+    //! Link clock now, or the clock set with setClock().
+    std::chrono::microseconds getHostTime() const;
+    double beatAtTime( std::chrono::microseconds hostTime ) const;
+    double phaseAtTime( std::chrono::microseconds hostTime ) const;
+    //! Host time at which the session timeline reaches \a beat.
+    std::chrono::microseconds timeAtBeat( double beat ) const;
+    //! Records that a sensor frame stamped \a sensorTicks (100 ns) arrived
+    //! at host time \a arrivalTime, refining a regression of the sensor
+    //! clock against the Link clock. Call once per new frame, with the time
+    //! read on the capture thread as the frame was acquired, so the fit does
+    //! not move with the load on the thread the frame is handled on.
+    void addSensorTime( long long sensorTicks, std::chrono::microseconds arrivalTime );
+    //! As above, arriving now.
+    void addSensorTime( long long sensorTicks );
+    //! Link host time at which the sensor stamped \a sensorTicks; the
+    //! current host time until a frame has been added.
+    std::chrono::microseconds sensorTimeToHostTime( long long sensorTicks ) const;
+    //! Sensor ticks at \a hostTime, the inverse of sensorTimeToHostTime().
+    //! Only meaningful once hasSensorTime().
+    long long hostTimeToSensorTime( std::chrono::microseconds hostTime ) const;
+    bool hasSensorTime() const;
+    //! The regression maps onto arrival times, so a constant delay between
+    //! the sensor stamping a frame and its arrival is not seen by it. This
+    //! calibrated delay is taken off every mapped time.
+    void setSensorLatency( std::chrono::microseconds latency );
+    std::chrono::microseconds getSensorLatency() const;
     size_t getNumPeers() const;
+    //! Called on a Link thread when the session tempo or play state
+    //! changes. Must not block; an empty function removes the callback.
+    void setTempoCallback( std::function<void( double )> callback );
+    void setStartStopCallback( std::function<void( bool )> callback );
     double getTempo() const;
     void stop();
     void start();
 
 private:
+    //! The virtual timeline or the app session state at \a hostTime.
+    Snapshot captureAt( std::chrono::microseconds hostTime ) const;
+
     using LinkStatePtr = std::unique_ptr<LinkState, std::function<void( LinkState * )>>;
     LinkStatePtr mLinkState;
+    Snapshot mSnapshot;
 };
\ No newline at end of file
@@ -32,10 +32,14 @@ if( NOT TARGET Cinder-Link )
 	source_group(Link FILES ${Link_SOURCES})
 
 	set( Cinder-Link_INCLUDES
+		${Cinder-Link_INC_PATH}/LinkScheduler.h
+		${Cinder-Link_INC_PATH}/LinkTimeline.h
 		${Cinder-Link_INC_PATH}/LinkWrapper.h
 	)
 
 	set( Cinder-Link_SOURCES
+		${Cinder-Link_SOURCE_PATH}/LinkScheduler.cpp
+		${Cinder-Link_SOURCE_PATH}/LinkTimeline.cpp
 		${Cinder-Link_SOURCE_PATH}/LinkWrapper.cpp
 	)
 
@@ -51,6 +55,12 @@ if( NOT TARGET Cinder-Link )
 
 	add_library( Cinder-Link ${Cinder-Link_LIBRARIES} )
 	target_include_directories(Cinder-Link PUBLIC "${CINDER_PATH}/include" ${Link_SOURCE_PATH} ${Link_INCLUDE_DIRS} ${Cinder-Link_INC_PATH} )
-	target_compile_definitions(Cinder-Link PUBLIC LINK_PLATFORM_WINDOWS=1)
+	if( WIN32 )
+		target_compile_definitions(Cinder-Link PUBLIC LINK_PLATFORM_WINDOWS=1)
+	elseif( APPLE )
+		target_compile_definitions(Cinder-Link PUBLIC LINK_PLATFORM_UNIX=1 LINK_PLATFORM_MACOSX=1)
+	else()
+		target_compile_definitions(Cinder-Link PUBLIC LINK_PLATFORM_UNIX=1 LINK_PLATFORM_LINUX=1)
+	endif()
 
 endif()
@@ -0,0 +1,245 @@
+#include "LinkScheduler.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "LinkWrapper.h"
+
+namespace
+{
+
+constexpr double NoBeat = -std::numeric_limits<double>::infinity();
+
+//! First boundary offset + k * interval after \a beat.
+double nextBoundary( double beat, double interval, double offset )
+{
+    return offset + interval * ( std::floor( ( beat - offset ) / interval ) + 1.0 );
+}
+
+} // namespace
+
+LinkScheduler::LinkScheduler( LinkWrapper &link )
+    : mLink( link )
+{
+}
+
+LinkScheduler::~LinkScheduler()
+{
+    stop();
+}
+
+int LinkScheduler::addHandler( double interval, double offset, Handler handler )
+{
+    if( interval <= 0.0 || !handler )
+    {
+        return 0;
+    }
+    int id = 0;
+    {
+        std::lock_guard<std::mutex> handlerLock( mHandlerMutex );
+        std::lock_guard<std::mutex> lock( mMutex );
+        id = mNextId++;
+        mHandlers.emplace_back( id, std::move( handler ) );
+        mSubscriptions.push_back( { id, interval, offset, NoBeat, NoBeat } );
+    }
+    mCondition.notify_all();
+    return id;
+}
+
+void LinkScheduler::removeHandler( int id )
+{
+    std::lock_guard<std::mutex> handlerLock( mHandlerMutex );
+    std::lock_guard<std::mutex> lock( mMutex );
+    mHandlers.erase( std::remove_if( mHandlers.begin(), mHandlers.end(),
+        [id]( const std::pair<int, Handler> &handler ) { return handler.first == id; } ), mHandlers.end() );
+    mSubscriptions.erase( std::remove_if( mSubscriptions.begin(), mSubscriptions.end(),
+        [id]( const Subscription &subscription ) { return subscription.id == id; } ), mSubscriptions.end() );
+}
+
+void LinkScheduler::start()
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    if( mRunning )
+    {
+        return;
+    }
+    mRunning = true;
+    mQueueHead.store( 0, std::memory_order_relaxed );
+    mQueueTail.store( 0, std::memory_order_relaxed );
+    mDispatching.store( true );
+    mDispatchThread = std::thread( &LinkScheduler::runDispatch, this );
+    mTimerThread = std::thread( &LinkScheduler::runTimer, this );
+}
+
+void LinkScheduler::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock( mMutex );
+        if( !mRunning )
+        {
+            return;
+        }
+        mRunning = false;
+    }
+    mCondition.notify_all();
+    mTimerThread.join();
+
+    mDispatching.store( false );
+    mDispatchSignal.fetch_add( 1, std::memory_order_release );
+    mDispatchSignal.notify_one();
+    mDispatchThread.join();
+}
+
+void LinkScheduler::runTimer()
+{
+    // The clock may be injected and driven by replayed time stamps, so it
+    // can run at any rate or stop. Its rate against steady time, measured
+    // between plans, turns host time to wait into real time to sleep.
+    auto lastHostTime = mLink.getHostTime();
+    auto lastSteadyTime = std::chrono::steady_clock::now();
+    double clockRate = 1.0;
+    const auto sleepFor = [&clockRate]( std::chrono::microseconds hostTime )
+    {
+        if( clockRate <= 0.0 )
+        {
+            return MaxSleep;
+        }
+        const auto steadyTime = std::chrono::microseconds( static_cast<long long>( static_cast<double>( hostTime.count() ) / clockRate ) );
+        return std::clamp<std::chrono::microseconds>( steadyTime, std::chrono::microseconds( 0 ), MaxSleep );
+    };
+
+    std::unique_lock<std::mutex> lock( mMutex );
+    while( mRunning )
+    {
+        // Plan the earliest boundary on the timeline as it is now.
+        const auto now = mLink.getHostTime();
+        const auto steadyNow = std::chrono::steady_clock::now();
+        if( steadyNow - lastSteadyTime >= RateInterval )
+        {
+            clockRate = static_cast<double>( ( now - lastHostTime ).count() )
+                / static_cast<double>( std::chrono::duration_cast<std::chrono::microseconds>( steadyNow - lastSteadyTime ).count() );
+            lastHostTime = now;
+            lastSteadyTime = steadyNow;
+        }
+        const double beat = mLink.beatAtTime( now );
+        double targetBeat = std::numeric_limits<double>::infinity();
+        for( Subscription &subscription : mSubscriptions )
+        {
+            if( beat < subscription.lastBeat - subscription.interval )
+            {
+                // The timeline jumped back.
+                subscription.lastBeat = NoBeat;
+            }
+            // A planned boundary the clock stepped past since, as a clock
+            // driven by frame stamps does, is fired late rather than lost.
+            const bool isPassed = subscription.nextBeat > subscription.lastBeat
+                && subscription.nextBeat <= beat && beat - subscription.nextBeat < subscription.interval;
+            if( !isPassed )
+            {
+                subscription.nextBeat = nextBoundary( std::max( beat, subscription.lastBeat ), subscription.interval, subscription.offset );
+            }
+            targetBeat = std::min( targetBeat, subscription.nextBeat );
+        }
+        if( mSubscriptions.empty() )
+        {
+            mCondition.wait( lock );
+            continue;
+        }
+
+        // A stalled clock is polled rather than spun on.
+        const auto target = mLink.timeAtBeat( targetBeat );
+        if( target - now > SpinTime || clockRate <= 0.0 )
+        {
+            mCondition.wait_for( lock, sleepFor( target - now - SpinTime ) );
+            continue;
+        }
+
+        // Spin for at most MaxSpin of real time: a clock that stalls short
+        // of the target is waited for at the planned rate instead.
+        lock.unlock();
+        const auto spinEnd = std::chrono::steady_clock::now() + MaxSpin;
+        auto hostTime = mLink.getHostTime();
+        while( hostTime < target && mRunning && std::chrono::steady_clock::now() < spinEnd )
+        {
+            std::this_thread::yield();
+            hostTime = mLink.getHostTime();
+        }
+        lock.lock();
+        if( hostTime < target )
+        {
+            if( mRunning )
+            {
+                clockRate = std::min( clockRate, static_cast<double>( ( hostTime - now ).count() ) / static_cast<double>( MaxSpin.count() ) );
+                mCondition.wait_for( lock, sleepFor( target - hostTime ) );
+            }
+            continue;
+        }
+
+        // Subscriptions added meanwhile have no plan yet and wait for the next round.
+        const auto firedTime = hostTime;
+        bool pushed = false;
+        for( Subscription &subscription : mSubscriptions )
+        {
+            if( subscription.nextBeat <= targetBeat )
+            {
+                subscription.lastBeat = subscription.nextBeat;
+                pushed |= pushEvent( { subscription.id, subscription.nextBeat, target, firedTime } );
+            }
+        }
+        if( pushed )
+        {
+            mDispatchSignal.fetch_add( 1, std::memory_order_release );
+            mDispatchSignal.notify_one();
+        }
+    }
+}
+
+void LinkScheduler::runDispatch()
+{
+    Event event;
+    while( true )
+    {
+        const uint32_t signal = mDispatchSignal.load( std::memory_order_acquire );
+        while( popEvent( event ) )
+        {
+            std::lock_guard<std::mutex> lock( mHandlerMutex );
+            for( const auto &handler : mHandlers )
+            {
+                if( handler.first == event.handlerId )
+                {
+                    handler.second( event );
+                    break;
+                }
+            }
+        }
+        if( !mDispatching.load() )
+        {
+            break;
+        }
+        mDispatchSignal.wait( signal, std::memory_order_acquire );
+    }
+}
+
+bool LinkScheduler::pushEvent( const Event &event )
+{
+    const uint32_t head = mQueueHead.load( std::memory_order_relaxed );
+    if( head - mQueueTail.load( std::memory_order_acquire ) == QueueSize )
+    {
+        mNumDropped.fetch_add( 1, std::memory_order_relaxed );
+        return false;
+    }
+    mQueue[ head % QueueSize ] = event;
+    mQueueHead.store( head + 1, std::memory_order_release );
+    return true;
+}
+
+bool LinkScheduler::popEvent( Event &event )
+{
+    const uint32_t tail = mQueueTail.load( std::memory_order_relaxed );
+    if( tail == mQueueHead.load( std::memory_order_acquire ) )
+    {
+        return false;
+    }
+    event = mQueue[ tail % QueueSize ];
+    mQueueTail.store( tail + 1, std::memory_order_release );
+    return true;
+}
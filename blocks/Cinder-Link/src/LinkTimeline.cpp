@@ -0,0 +1,192 @@
+#include "LinkTimeline.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace
+{
+
+// File layout: Magic, Version, then fixed-size little-endian records.
+const char Magic[ 4 ] = { 'H', 'D', 'L', 'T' };
+constexpr uint32_t Version = 1;
+constexpr size_t RecordSize = 8 + 8 + 8 + 8 + 8 + 1;
+constexpr long long NoChange = std::numeric_limits<long long>::max();
+//! A snapshot further than this off the last record's line is a new timeline.
+constexpr double BeatTolerance = 1.0e-4;
+
+template<typename T>
+void put( uint8_t *&dst, T value )
+{
+    std::memcpy( dst, &value, sizeof( T ) );
+    dst += sizeof( T );
+}
+
+template<typename T>
+T get( const uint8_t *&src )
+{
+    T value;
+    std::memcpy( &value, src, sizeof( T ) );
+    src += sizeof( T );
+    return value;
+}
+
+} // namespace
+
+LinkTimelineRecorderRef LinkTimelineRecorder::create( LinkWrapper &link, const std::string &path )
+{
+    return LinkTimelineRecorderRef( new LinkTimelineRecorder( link, path ) );
+}
+
+LinkTimelineRecorder::LinkTimelineRecorder( LinkWrapper &link, const std::string &path )
+    : mLink( link )
+    , mStream( path, std::ios::binary | std::ios::trunc )
+    , mChangeTime( NoChange )
+{
+    if( !mStream )
+    {
+        throw std::runtime_error( "Failed to open Link timeline for writing: " + path );
+    }
+    mStream.write( Magic, sizeof( Magic ) );
+    mStream.write( reinterpret_cast<const char *>( &Version ), sizeof( Version ) );
+
+    // Link thread: note the earliest change time and return.
+    const auto noteChange = [this]
+    {
+        const long long now = mLink.getHostTime().count();
+        long long pending = mChangeTime.load( std::memory_order_relaxed );
+        while( now < pending && !mChangeTime.compare_exchange_weak( pending, now, std::memory_order_relaxed ) )
+        {
+        }
+    };
+    mLink.setTempoCallback( [noteChange]( double ) { noteChange(); } );
+    mLink.setStartStopCallback( [noteChange]( bool ) { noteChange(); } );
+}
+
+LinkTimelineRecorder::~LinkTimelineRecorder()
+{
+    mLink.setTempoCallback( nullptr );
+    mLink.setStartStopCallback( nullptr );
+}
+
+void LinkTimelineRecorder::update()
+{
+    if( !mLink.hasSensorTime() )
+    {
+        return;
+    }
+    const LinkWrapper::Snapshot &snapshot = mLink.getSnapshot();
+    // The callbacks only date a change; whether there is one is decided
+    // here, so a callback arriving after its change was written adds nothing.
+    const long long changeTime = mChangeTime.exchange( NoChange, std::memory_order_relaxed );
+    const bool changed = !mHasRecord
+        || snapshot.isPlaying != mLastRecord.isPlaying
+        || snapshot.tempo != mLastRecord.tempo
+        || std::abs( mLastRecord.beatAtTime( snapshot.hostTime ) - snapshot.beat ) > BeatTolerance;
+    if( !changed )
+    {
+        return;
+    }
+
+    // The snapshot's line holds from the change on, so record it from the
+    // moment the callback saw, not from this tick.
+    LinkWrapper::Snapshot record = snapshot;
+    if( mHasRecord && changeTime > mLastRecord.hostTime.count() && changeTime < snapshot.hostTime.count() )
+    {
+        record.hostTime = std::chrono::microseconds( changeTime );
+        record.beat = snapshot.beatAtTime( record.hostTime );
+        record.phase = snapshot.phaseAtTime( record.hostTime );
+    }
+    write( record );
+}
+
+void LinkTimelineRecorder::write( const LinkWrapper::Snapshot &snapshot )
+{
+    uint8_t buffer[ RecordSize ];
+    uint8_t *dst = buffer;
+    put<int64_t>( dst, snapshot.hostTime.count() );
+    put<int64_t>( dst, mLink.hostTimeToSensorTime( snapshot.hostTime ) );
+    put<double>( dst, snapshot.tempo );
+    put<double>( dst, snapshot.beat );
+    put<double>( dst, snapshot.quantum );
+    put<uint8_t>( dst, snapshot.isPlaying ? 1 : 0 );
+    mStream.write( reinterpret_cast<const char *>( buffer ), RecordSize );
+    mStream.flush();
+
+    mLastRecord = snapshot;
+    mHasRecord = true;
+    ++mNumRecords;
+}
+
+LinkTimelinePlayerRef LinkTimelinePlayer::create( const std::string &path )
+{
+    return LinkTimelinePlayerRef( new LinkTimelinePlayer( path ) );
+}
+
+LinkTimelinePlayer::LinkTimelinePlayer( const std::string &path )
+{
+    std::ifstream stream( path, std::ios::binary );
+    char magic[ sizeof( Magic ) ] = {};
+    uint32_t version = 0;
+    stream.read( magic, sizeof( magic ) );
+    stream.read( reinterpret_cast<char *>( &version ), sizeof( version ) );
+    if( !stream || std::memcmp( magic, Magic, sizeof( Magic ) ) != 0 || version != Version )
+    {
+        throw std::runtime_error( "Not a Link timeline: " + path );
+    }
+
+    uint8_t buffer[ RecordSize ];
+    while( stream.read( reinterpret_cast<char *>( buffer ), RecordSize ) )
+    {
+        const uint8_t *src = buffer;
+        LinkTimelineRecord record;
+        record.hostTime = get<int64_t>( src );
+        record.sensorTime = get<int64_t>( src );
+        record.tempo = get<double>( src );
+        record.beat = get<double>( src );
+        record.quantum = get<double>( src );
+        record.isPlaying = get<uint8_t>( src );
+        mRecords.push_back( record );
+    }
+    // Written in host time order; a recording cut short may end mid-record,
+    // which the loop above leaves out.
+    std::stable_sort( mRecords.begin(), mRecords.end(),
+        []( const LinkTimelineRecord &a, const LinkTimelineRecord &b ) { return a.sensorTime < b.sensorTime; } );
+}
+
+const LinkTimelineRecord *LinkTimelinePlayer::getRecordAt( long long sensorTime ) const
+{
+    if( mRecords.empty() )
+    {
+        return nullptr;
+    }
+    const auto next = std::upper_bound( mRecords.begin(), mRecords.end(), sensorTime,
+        []( long long time, const LinkTimelineRecord &record ) { return time < record.sensorTime; } );
+    return next == mRecords.begin() ? &mRecords.front() : &*( next - 1 );
+}
+
+void LinkTimelinePlayer::update( LinkWrapper &link, long long sensorTime )
+{
+    const LinkTimelineRecord *found = getRecordAt( sensorTime );
+    if( !found )
+    {
+        return;
+    }
+    const size_t current = static_cast<size_t>( found - mRecords.data() );
+    if( mHasCurrent && current == mCurrent && link.hasTimeline() )
+    {
+        return;
+    }
+    mCurrent = current;
+    mHasCurrent = true;
+
+    const LinkTimelineRecord &record = *found;
+    LinkWrapper::Snapshot timeline;
+    timeline.hostTime = link.sensorTimeToHostTime( record.sensorTime );
+    timeline.tempo = record.tempo;
+    timeline.beat = record.beat;
+    timeline.quantum = record.quantum;
+    timeline.isPlaying = record.isPlaying != 0;
+    link.setTimeline( timeline );
+}
@@ -1,5 +1,20 @@
 #include "LinkWrapper.h"
+#include <atomic>
+#include <cmath>
 #include <AudioPlatform_Dummy.hpp>
+#include <ableton/link/HostTimeFilter.hpp>
+
+//! Last snapshot taken from the audio session state, guarded by a sequence
+//! number that is odd while it is being written.
+struct PublishedSnapshot
+{
+    std::atomic<unsigned> sequence{ 0 };
+    std::atomic<long long> hostTime{ 0 };
+    std::atomic<double> tempo{ 120.0 };
+    std::atomic<double> beat{ 0.0 };
+    std::atomic<double> quantum{ 4.0 };
+    std::atomic<bool> isPlaying{ false };
+};
 
 struct LinkState
 {
@@ -7,6 +22,22 @@ struct LinkState
     ableton::Link link{ 120.0 };
     ableton::linkaudio::AudioPlatform audioPlatform{ link };
 
+    // Sensor ticks are fed in as microseconds since the first frame, which
+    // keeps the regression sums small.
+    ableton::link::IncrementalHostTimeFilter<ableton::link::platform::Clock> hostTimeFilter;
+    long long sensorOrigin{ -1 };
+    long long lastSensorTicks{ -1 };
+    std::chrono::microseconds sensorLatency{ 0 };
+
+    // captureAudioSessionState() must not run on two threads at once; the
+    // flag picks which caller captures.
+    std::atomic_flag isCapturingRealtime = ATOMIC_FLAG_INIT;
+    PublishedSnapshot realtimeSnapshot;
+
+    LinkWrapper::Clock clock;
+    std::atomic<bool> hasTimeline{ false };
+    PublishedSnapshot timeline;
+
     //LinkState()
     //    : running( true )
     //    , link( 120.0 )
@@ -15,10 +46,153 @@ struct LinkState
     //}
 };
 
+namespace
+{
+
+double positiveModulo( double x, double quantum )
+{
+    return quantum > 0.0 ? x - quantum * std::floor( x / quantum ) : 0.0;
+}
+
+LinkWrapper::Snapshot makeSnapshot( const ableton::Link::SessionState &sessionState, std::chrono::microseconds hostTime, double quantum )
+{
+    LinkWrapper::Snapshot snapshot;
+    snapshot.hostTime = hostTime;
+    snapshot.tempo = sessionState.tempo();
+    snapshot.beat = sessionState.beatAtTime( hostTime, quantum );
+    snapshot.phase = sessionState.phaseAtTime( hostTime, quantum );
+    snapshot.quantum = quantum;
+    snapshot.isPlaying = sessionState.isPlaying();
+    return snapshot;
+}
+
+void publish( PublishedSnapshot &published, const LinkWrapper::Snapshot &snapshot )
+{
+    const unsigned sequence = published.sequence.load( std::memory_order_relaxed );
+    published.sequence.store( sequence + 1, std::memory_order_relaxed );
+    std::atomic_thread_fence( std::memory_order_release );
+    published.hostTime.store( snapshot.hostTime.count(), std::memory_order_relaxed );
+    published.tempo.store( snapshot.tempo, std::memory_order_relaxed );
+    published.beat.store( snapshot.beat, std::memory_order_relaxed );
+    published.quantum.store( snapshot.quantum, std::memory_order_relaxed );
+    published.isPlaying.store( snapshot.isPlaying, std::memory_order_relaxed );
+    published.sequence.store( sequence + 2, std::memory_order_release );
+}
+
+//! Reads the last published snapshot, retrying while it is being written.
+LinkWrapper::Snapshot readPublished( const PublishedSnapshot &published )
+{
+    LinkWrapper::Snapshot snapshot;
+    unsigned before = 0;
+    unsigned after = 0;
+    do
+    {
+        before = published.sequence.load( std::memory_order_acquire );
+        snapshot.hostTime = std::chrono::microseconds( published.hostTime.load( std::memory_order_relaxed ) );
+        snapshot.tempo = published.tempo.load( std::memory_order_relaxed );
+        snapshot.beat = published.beat.load( std::memory_order_relaxed );
+        snapshot.quantum = published.quantum.load( std::memory_order_relaxed );
+        snapshot.isPlaying = published.isPlaying.load( std::memory_order_relaxed );
+        std::atomic_thread_fence( std::memory_order_acquire );
+        after = published.sequence.load( std::memory_order_relaxed );
+    } while( ( before & 1 ) != 0 || before != after );
+    snapshot.phase = positiveModulo( snapshot.beat, snapshot.quantum );
+    return snapshot;
+}
+
+} // namespace
+
+double LinkWrapper::Snapshot::beatAtTime( std::chrono::microseconds time ) const
+{
+    return beat + static_cast<double>( ( time - hostTime ).count() ) * tempo / 60.0e6;
+}
+
+double LinkWrapper::Snapshot::phaseAtTime( std::chrono::microseconds time ) const
+{
+    return positiveModulo( beatAtTime( time ), quantum );
+}
+
+std::chrono::microseconds LinkWrapper::Snapshot::timeAtBeat( double atBeat ) const
+{
+    return hostTime + std::chrono::microseconds( std::llround( ( atBeat - beat ) * 60.0e6 / tempo ) );
+}
+
 LinkWrapper::LinkWrapper()
 {
     //mLinkState = std::make_unique<LinkState>();
     mLinkState = LinkStatePtr( new LinkState(), [] ( LinkState *ls) { delete ls; } );
+    // So that readers never see an empty timeline.
+    captureSnapshot();
+    captureRealtimeSnapshot();
+}
+
+const LinkWrapper::Snapshot &LinkWrapper::captureSnapshot()
+{
+    mSnapshot = captureAt( getHostTime() );
+    return mSnapshot;
+}
+
+const LinkWrapper::Snapshot &LinkWrapper::getSnapshot() const
+{
+    return mSnapshot;
+}
+
+LinkWrapper::Snapshot LinkWrapper::captureRealtimeSnapshot() const
+{
+    LinkState &state = *mLinkState;
+    const auto hostTime = getHostTime();
+    if( state.hasTimeline.load( std::memory_order_acquire ) )
+    {
+        return captureAt( hostTime );
+    }
+    if( !state.isCapturingRealtime.test_and_set( std::memory_order_acquire ) )
+    {
+        const Snapshot snapshot = makeSnapshot( state.link.captureAudioSessionState(), hostTime, state.audioPlatform.mEngine.quantum() );
+        publish( state.realtimeSnapshot, snapshot );
+        state.isCapturingRealtime.clear( std::memory_order_release );
+        return snapshot;
+    }
+    // Another thread is capturing: carry the last timeline forward.
+    Snapshot snapshot = readPublished( state.realtimeSnapshot );
+    snapshot.beat = snapshot.beatAtTime( hostTime );
+    snapshot.phase = positiveModulo( snapshot.beat, snapshot.quantum );
+    snapshot.hostTime = hostTime;
+    return snapshot;
+}
+
+void LinkWrapper::setClock( Clock clock )
+{
+    mLinkState->clock = std::move( clock );
+}
+
+void LinkWrapper::setTimeline( const Snapshot &timeline )
+{
+    publish( mLinkState->timeline, timeline );
+    mLinkState->hasTimeline.store( true, std::memory_order_release );
+}
+
+void LinkWrapper::clearTimeline()
+{
+    mLinkState->hasTimeline.store( false, std::memory_order_release );
+}
+
+bool LinkWrapper::hasTimeline() const
+{
+    return mLinkState->hasTimeline.load( std::memory_order_acquire );
+}
+
+LinkWrapper::Snapshot LinkWrapper::captureAt( std::chrono::microseconds hostTime ) const
+{
+    const LinkState &state = *mLinkState;
+    if( state.hasTimeline.load( std::memory_order_acquire ) )
+    {
+        Snapshot snapshot = readPublished( state.timeline );
+        snapshot.beat = snapshot.beatAtTime( hostTime );
+        snapshot.phase = positiveModulo( snapshot.beat, snapshot.quantum );
+        snapshot.hostTime = hostTime;
+        return snapshot;
+    }
+    return makeSnapshot( mLinkState->link.captureAppSessionState(), hostTime, state.audioPlatform.mEngine.quantum() );
 }
 
 bool LinkWrapper::getIsEnabled() const
@@ -33,27 +207,112 @@ void LinkWrapper::setIsEnabled( bool state )
 
 double LinkWrapper::getBeat() const
 {
-    const auto time = mLinkState->link.clock().micros();
-    auto sessionState = mLinkState->link.captureAppSessionState();
-    auto quantum = mLinkState->audioPlatform.mEngine.quantum();
-    return sessionState.beatAtTime( time, quantum );
+    return beatAtTime( getHostTime() );
 }
 
 double LinkWrapper::getPhase() const
 {
-    const auto time = mLinkState->link.clock().micros();
-    auto sessionState = mLinkState->link.captureAppSessionState();
-    auto quantum = mLinkState->audioPlatform.mEngine.quantum();
-    return sessionState.phaseAtTime( time, quantum );
+    return phaseAtTime( getHostTime() );
 }
 
 double LinkWrapper::getBeatAndPhase( double &phase ) const
 {
-    const auto time = mLinkState->link.clock().micros();
+    const Snapshot snapshot = captureAt( getHostTime() );
+    phase = snapshot.phase;
+    return snapshot.beat;
+}
+
+std::chrono::microseconds LinkWrapper::getHostTime() const
+{
+    const LinkState &state = *mLinkState;
+    return state.clock ? state.clock() : state.link.clock().micros();
+}
+
+double LinkWrapper::beatAtTime( std::chrono::microseconds hostTime ) const
+{
+    return captureAt( hostTime ).beat;
+}
+
+double LinkWrapper::phaseAtTime( std::chrono::microseconds hostTime ) const
+{
+    return captureAt( hostTime ).phase;
+}
+
+std::chrono::microseconds LinkWrapper::timeAtBeat( double beat ) const
+{
+    if( hasTimeline() )
+    {
+        return readPublished( mLinkState->timeline ).timeAtBeat( beat );
+    }
     auto sessionState = mLinkState->link.captureAppSessionState();
     auto quantum = mLinkState->audioPlatform.mEngine.quantum();
-    phase = sessionState.phaseAtTime( time, quantum );;
-    return sessionState.beatAtTime( time, quantum );
+    return sessionState.timeAtBeat( beat, quantum );
+}
+
+void LinkWrapper::addSensorTime( long long sensorTicks )
+{
+    addSensorTime( sensorTicks, getHostTime() );
+}
+
+void LinkWrapper::addSensorTime( long long sensorTicks, std::chrono::microseconds arrivalTime )
+{
+    LinkState &state = *mLinkState;
+    if( state.sensorOrigin < 0 || sensorTicks <= state.lastSensorTicks )
+    {
+        // First frame, or the sensor clock restarted (replay loop, reconnect).
+        state.hostTimeFilter.reset();
+        state.sensorOrigin = sensorTicks;
+    }
+    state.lastSensorTicks = sensorTicks;
+    const double micros = static_cast<double>( sensorTicks - state.sensorOrigin ) / 10.0;
+    state.hostTimeFilter.addSample( micros, arrivalTime );
+}
+
+std::chrono::microseconds LinkWrapper::sensorTimeToHostTime( long long sensorTicks ) const
+{
+    const LinkState &state = *mLinkState;
+    if( state.sensorOrigin < 0 )
+    {
+        return getHostTime();
+    }
+    // The fit is cheap to evaluate, so any time stamp is mapped through it.
+    const double micros = static_cast<double>( sensorTicks - state.sensorOrigin ) / 10.0;
+    return state.hostTimeFilter.hostTimeAtSampleTime( micros ) - state.sensorLatency;
+}
+
+long long LinkWrapper::hostTimeToSensorTime( std::chrono::microseconds hostTime ) const
+{
+    const LinkState &state = *mLinkState;
+    if( state.sensorOrigin < 0 )
+    {
+        return -1;
+    }
+    // The fit is a line; two points of it give the inverse.
+    constexpr double Span = 1.0e6;
+    const auto start = sensorTimeToHostTime( state.sensorOrigin );
+    const auto end = sensorTimeToHostTime( state.sensorOrigin + static_cast<long long>( Span * 10.0 ) );
+    const double slope = static_cast<double>( ( end - start ).count() ) / Span;
+    if( slope <= 0.0 )
+    {
+        return state.lastSensorTicks;
+    }
+    const double micros = static_cast<double>( ( hostTime - start ).count() ) / slope;
+    return state.sensorOrigin + std::llround( micros * 10.0 );
+}
+
+bool LinkWrapper::hasSensorTime() const
+{
+    return mLinkState->sensorOrigin >= 0;
+}
+
+void LinkWrapper::setSensorLatency( std::chrono::microseconds latency )
+{
+    mLinkState->sensorLatency = latency;
+}
+
+std::chrono::microseconds LinkWrapper::getSensorLatency() const
+{
+    return mLinkState->sensorLatency;
 }
 
 size_t LinkWrapper::getNumPeers() const
@@ -61,9 +320,28 @@ size_t LinkWrapper::getNumPeers() const
     return mLinkState->link.numPeers();
 }
 
+void LinkWrapper::setTempoCallback( std::function<void( double )> callback )
+{
+    // Link calls whatever is set, so removing means a no-op.
+    if( !callback )
+    {
+        callback = []( double ) {};
+    }
+    mLinkState->link.setTempoCallback( std::move( callback ) );
+}
+
+void LinkWrapper::setStartStopCallback( std::function<void( bool )> callback )
+{
+    if( !callback )
+    {
+        callback = []( bool ) {};
+    }
+    mLinkState->link.setStartStopCallback( std::move( callback ) );
+}
+
 double LinkWrapper::getTempo() const
 {
-    return mLinkState->link.captureAppSessionState().tempo();
+    return captureAt( getHostTime() ).tempo;
 }
 
 void LinkWrapper::stop()
@@ -0,0 +1,120 @@
+#include "BodyTrackTable.h"
+
+BodyTrackTable::BodyTrackTable()
+{
+    for( size_t i = 0; i < Capacity; ++i )
+    {
+        mGenerations[ i ] = 0;
+    }
+    clear();
+}
+
+BodyTrackTable::Handle BodyTrackTable::acquire( uint64_t trackingId, size_t slot, long long timeStamp )
+{
+    slot = slot < Capacity ? slot : 0;
+    size_t index = Capacity;
+    if( mIds[ slot ] == trackingId )
+    {
+        index = slot;
+    }
+    else
+    {
+        for( size_t i = 0; i < Capacity; ++i )
+        {
+            if( mIds[ i ] == trackingId )
+            {
+                index = i;
+                break;
+            }
+        }
+    }
+
+    if( index == Capacity )
+    {
+        index = findFree( slot );
+        if( mIds[ index ] != 0 )
+        {
+            ++mNumEvictions;
+        }
+        reset( index );
+        mIds[ index ] = trackingId;
+    }
+    mLastSeen[ index ] = timeStamp;
+
+    Handle handle;
+    handle.index = static_cast<uint32_t>( index );
+    handle.generation = mGenerations[ index ];
+    return handle;
+}
+
+size_t BodyTrackTable::findFree( size_t slot ) const
+{
+    if( mIds[ slot ] == 0 )
+    {
+        return slot;
+    }
+    size_t oldest = slot;
+    for( size_t i = 0; i < Capacity; ++i )
+    {
+        if( mIds[ i ] == 0 )
+        {
+            return i;
+        }
+        if( mLastSeen[ i ] < mLastSeen[ oldest ] )
+        {
+            oldest = i;
+        }
+    }
+    // Full: the least recently seen entry, the slot's own one on a tie.
+    return oldest;
+}
+
+void BodyTrackTable::evictStale( long long timeStamp )
+{
+    for( size_t i = 0; i < Capacity; ++i )
+    {
+        if( mIds[ i ] != 0 && timeStamp - mLastSeen[ i ] > StaleTicks )
+        {
+            reset( i );
+            ++mNumEvictions;
+        }
+    }
+}
+
+void BodyTrackTable::clear()
+{
+    for( size_t i = 0; i < Capacity; ++i )
+    {
+        reset( i );
+    }
+}
+
+size_t BodyTrackTable::getNumActive() const
+{
+    size_t count = 0;
+    for( size_t i = 0; i < Capacity; ++i )
+    {
+        count += mIds[ i ] != 0 ? 1 : 0;
+    }
+    return count;
+}
+
+void BodyTrackTable::reset( size_t index )
+{
+    mIds[ index ] = 0;
+    mLastSeen[ index ] = 0;
+    ++mGenerations[ index ];
+    for( size_t side = 0; side < SideCount; ++side )
+    {
+        feet.isUp[ index ][ side ] = false;
+        feet.isDown[ index ][ side ] = true;
+        feet.hasEmittedRing[ index ][ side ] = false;
+        feet.yPrevPos[ index ][ side ] = 0.0f;
+        feet.yPrevVel[ index ][ side ] = 0.0f;
+        knees.isUp[ index ][ side ] = false;
+        knees.hasEmittedRing[ index ][ side ] = false;
+    }
+    calibration.standingKneeY[ index ] = 0.0f;
+    calibration.standingHipY[ index ] = 0.0f;
+    calibration.isKneeCalibrated[ index ] = false;
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <Kinect2Types.h>
+
+//! Fixed-capacity detection state for the bodies in view, stored as
+//! columns indexed by table entry. A known tracking ID keeps its entry. A
+//! new ID takes the entry for its Kinect body slot if that entry is free,
+//! otherwise any free entry; only when every entry is taken is the least
+//! recently seen one evicted. Every reuse bumps the entry's generation so
+//! stale handles can be detected. Nothing is allocated after construction.
+class BodyTrackTable
+{
+public:
+    static constexpr size_t Capacity = BODY_COUNT;
+    //! Entries not seen for this long are freed (0.5 s in sensor ticks).
+    static constexpr long long StaleTicks = 5000000LL;
+
+    enum Side
+    {
+        Left,
+        Right,
+        SideCount
+    };
+
+    struct Handle
+    {
+        uint32_t index{ 0 };
+        uint32_t generation{ 0 };
+    };
+
+    struct Feet
+    {
+        bool isUp[ Capacity ][ SideCount ];
+        bool isDown[ Capacity ][ SideCount ];
+        bool hasEmittedRing[ Capacity ][ SideCount ];
+        //! Height (m) and filtered vertical velocity (m/s) last frame.
+        float yPrevPos[ Capacity ][ SideCount ];
+        float yPrevVel[ Capacity ][ SideCount ];
+    };
+    struct Knees
+    {
+        bool isUp[ Capacity ][ SideCount ];
+        bool hasEmittedRing[ Capacity ][ SideCount ];
+    };
+    struct Calibration
+    {
+        float standingKneeY[ Capacity ];
+        float standingHipY[ Capacity ];
+        bool isKneeCalibrated[ Capacity ];
+    };
+
+    BodyTrackTable();
+
+    //! Returns the entry for \a trackingId, seen in body \a slot at
+    //! \a timeStamp, claiming and resetting one if the ID is new.
+    Handle acquire( uint64_t trackingId, size_t slot, long long timeStamp );
+    //! False once the entry behind \a handle was handed to another body.
+    bool isCurrent( const Handle &handle ) const;
+    //! Frees entries whose body has not been seen since \a timeStamp - StaleTicks.
+    void evictStale( long long timeStamp );
+    void clear();
+
+    size_t getNumActive() const;
+    uint64_t getNumEvictions() const;
+
+    Feet feet;
+    Knees knees;
+    Calibration calibration;
+
+private:
+    void reset( size_t index );
+    size_t findFree( size_t slot ) const;
+
+    // Kinect tracking IDs are never 0, so 0 marks a free entry.
+    uint64_t mIds[ Capacity ];
+    uint32_t mGenerations[ Capacity ];
+    long long mLastSeen[ Capacity ];
+    uint64_t mNumEvictions{ 0 };
+};
+
+inline bool BodyTrackTable::isCurrent( const Handle &handle ) const { return handle.index < Capacity && mGenerations[ handle.index ] == handle.generation; }
+inline uint64_t BodyTrackTable::getNumEvictions() const { return mNumEvictions; }
@@ -0,0 +1,280 @@
+#include "DanceDetector.h"
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <cinder/CinderMath.h>
+#include <cinder/Log.h>
+
+namespace
+{
+
+constexpr double TicksPerSecond = 10000000.0;
+
+// Real-time quadratic fit over FilterWindow at the given frame period.
+SavitzkyGolayFilter::Options filterOptions( double framePeriod )
+{
+    const double halfWindow = std::round( DanceDetector::FilterWindow / ( 2.0 * framePeriod ) );
+    const unsigned m = static_cast<unsigned>( std::min( std::max( halfWindow, 1.0 ), ( SavitzkyGolayFilterBank::MaxWindowSize - 1 ) / 2.0 ) );
+    return SavitzkyGolayFilter::Options( m, static_cast<int>( m ), 2, 0, static_cast<float>( framePeriod ) );
+}
+
+} // namespace
+
+DanceDetector::DanceDetector()
+{
+    mFilterBank.configure( filterOptions( FramePeriod ) );
+}
+
+void DanceDetector::process( const Kinect2::BodyFrame &frame, std::vector<DanceEvent> &events )
+{
+    const long long timeStamp = frame.getTimeStamp();
+    mTrackTable.evictStale( timeStamp );
+    updateFramePeriod( timeStamp );
+
+    // Every tracked body goes into the filter bank before any is detected
+    // on, so the velocities below are this frame's.
+    size_t entries[ BodyTrackTable::Capacity ];
+    const std::vector<Kinect2::Body> &bodies = frame.getBodies();
+    const size_t numBodies = std::min( bodies.size(), BodyTrackTable::Capacity );
+    for( size_t i = 0; i < numBodies; ++i )
+    {
+        if( bodies[ i ].isTracked() )
+        {
+            const BodyTrackTable::Handle handle = mTrackTable.acquire( bodies[ i ].getId(), bodies[ i ].getIndex(), timeStamp );
+            entries[ i ] = handle.index;
+            filter( bodies[ i ], handle.index, handle.generation, timeStamp );
+        }
+    }
+    mFilterBank.push( timeStamp );
+
+    for( size_t i = 0; i < numBodies; ++i )
+    {
+        if( bodies[ i ].isTracked() )
+        {
+            estimateFloor( bodies[ i ] );
+            track( bodies[ i ], entries[ i ], timeStamp, events );
+        }
+    }
+    mPrevTimeStamp = timeStamp;
+}
+
+void DanceDetector::reset()
+{
+    mTrackTable.clear();
+    mFilterBank.configure( filterOptions( FramePeriod ) );
+    mNumFrameIntervals = 0;
+    std::fill( std::begin( mFilterGenerations ), std::end( mFilterGenerations ), 0 );
+    std::fill( std::begin( mFilterTimeStamps ), std::end( mFilterTimeStamps ), 0 );
+    mPrevTimeStamp = -1;
+    mFloorY = 1000.0f;
+    mHasFloorY = false;
+}
+
+void DanceDetector::updateFramePeriod( long long timeStamp )
+{
+    if( mPrevTimeStamp < 0 || timeStamp <= mPrevTimeStamp )
+    {
+        return;
+    }
+    mFrameIntervals[ mNumFrameIntervals % NumFrameIntervals ] = timeStamp - mPrevTimeStamp;
+    ++mNumFrameIntervals;
+    if( mNumFrameIntervals < NumFrameIntervals / 2 )
+    {
+        return;
+    }
+
+    // The median is unmoved by the odd dropped frame or late time stamp.
+    long long intervals[ NumFrameIntervals ];
+    const size_t count = std::min( mNumFrameIntervals, NumFrameIntervals );
+    std::copy( mFrameIntervals, mFrameIntervals + count, intervals );
+    std::nth_element( intervals, intervals + count / 2, intervals + count );
+    const double period = static_cast<double>( intervals[ count / 2 ] ) / TicksPerSecond;
+
+    // Only a real change of source rate restarts the filter.
+    const double current = mFilterBank.getOptions().timeStep();
+    if( std::abs( period - current ) > 0.25 * current )
+    {
+        CI_LOG_I( "Frame period " + std::to_string( period ) + " s" );
+        mFilterBank.configure( filterOptions( period ) );
+    }
+}
+
+void DanceDetector::filter( const Kinect2::Body &body, size_t entry, uint32_t generation, long long timeStamp )
+{
+    // A new person in the entry, or one back from a gap, starts a fresh
+    // window rather than inheriting a jump.
+    if( mFilterGenerations[ entry ] != generation || mFilterTimeStamps[ entry ] != mPrevTimeStamp )
+    {
+        mFilterBank.resetBody( entry );
+    }
+    mFilterGenerations[ entry ] = generation;
+    mFilterTimeStamps[ entry ] = timeStamp;
+    for( size_t joint = 0; joint < JointType_Count; ++joint )
+    {
+        const JointType type = static_cast<JointType>( joint );
+        if( body.hasJoint( type ) )
+        {
+            mFilterBank.setPosition( entry, joint, body.getJointPosition( type ) );
+        }
+    }
+}
+
+long long DanceDetector::findCrossing( float prevY, float prevVelocity, float y, float threshold, long long timeStamp ) const
+{
+    if( mPrevTimeStamp < 0 || prevY <= threshold )
+    {
+        return timeStamp;
+    }
+    const long long interval = timeStamp - mPrevTimeStamp;
+    double seconds = 0.0;
+    if( prevVelocity < -MinOnsetSpeed )
+    {
+        // Carried on from the previous frame, while the foot was still in
+        // the air: a landing stops it dead, so the velocity on this frame
+        // no longer says how fast it came down.
+        seconds = static_cast<double>( threshold - prevY ) / static_cast<double>( prevVelocity );
+    }
+    else
+    {
+        seconds = static_cast<double>( prevY - threshold ) / static_cast<double>( prevY - y ) * interval / TicksPerSecond;
+    }
+    const long long ticks = std::llround( std::max( seconds, 0.0 ) * TicksPerSecond );
+    return mPrevTimeStamp + std::min( ticks, interval );
+}
+
+void DanceDetector::estimateFloor( const Kinect2::Body &body )
+{
+    if( !body.hasJoint( JointType_FootLeft ) || !body.hasJoint( JointType_FootRight ) )
+    {
+        return;
+    }
+    const ci::vec3 leftFoot = body.getJointPosition( JointType_FootLeft );
+    const ci::vec3 rightFoot = body.getJointPosition( JointType_FootRight );
+    if( std::abs( leftFoot.y - rightFoot.y ) < 0.001 )
+    {
+        // Both feet level: the lowest one seen so far is the floor.
+        const float floorY = std::min( leftFoot.y, rightFoot.y );
+        mFloorY = std::min( floorY, mFloorY );
+        mHasFloorY = true;
+    }
+}
+
+void DanceDetector::track( const Kinect2::Body &body, size_t entry, long long timeStamp, std::vector<DanceEvent> &events )
+{
+    using Side = BodyTrackTable::Side;
+
+    const uint64_t trackingId = body.getId();
+
+    const ci::vec3 leftFootPos = kinectToCinder( body.getJointPosition( JointType_FootLeft ) );
+    const ci::vec3 rightFootPos = kinectToCinder( body.getJointPosition( JointType_FootRight ) );
+    const ci::vec3 leftKneePos = kinectToCinder( body.getJointPosition( JointType_KneeLeft ) );
+    const ci::vec3 rightKneePos = kinectToCinder( body.getJointPosition( JointType_KneeRight ) );
+    const ci::vec3 leftHipPos = kinectToCinder( body.getJointPosition( JointType_HipLeft ) );
+    const ci::vec3 rightHipPos = kinectToCinder( body.getJointPosition( JointType_HipRight ) );
+
+    const float leftFootVelocity = mFilterBank.getVelocity( entry, JointType_FootLeft ).y;
+    const float rightFootVelocity = mFilterBank.getVelocity( entry, JointType_FootRight ).y;
+
+    detectFootStep( entry, Side::Left, leftFootVelocity, leftFootPos, leftKneePos, leftHipPos.y, trackingId, timeStamp, events );
+    detectFootStep( entry, Side::Right, rightFootVelocity, rightFootPos, rightKneePos, rightHipPos.y, trackingId, timeStamp, events );
+    const float leftKneeVelocity = mFilterBank.getVelocity( entry, JointType_KneeLeft ).y;
+    const float rightKneeVelocity = mFilterBank.getVelocity( entry, JointType_KneeRight ).y;
+    detectKneeRaise( entry, Side::Left, leftKneeVelocity, leftKneePos, trackingId, timeStamp, events );
+    detectKneeRaise( entry, Side::Right, rightKneeVelocity, rightKneePos, trackingId, timeStamp, events );
+}
+
+void DanceDetector::detectFootStep(
+    size_t entry,
+    BodyTrackTable::Side side,
+    float footVelocity,
+    const ci::vec3 &footPos,
+    const ci::vec3 &kneePos,
+    float hipY,
+    uint64_t bodyId,
+    long long timeStamp,
+    std::vector<DanceEvent> &events
+)
+{
+    BodyTrackTable::Feet &feet = mTrackTable.feet;
+    BodyTrackTable::Calibration &calibration = mTrackTable.calibration;
+    if( !feet.isUp[ entry ][ side ] )
+    {
+        if( footPos.y > ( mFloorY + FootUpThresh ) )
+        {
+            feet.isUp[ entry ][ side ] = true;
+            feet.isDown[ entry ][ side ] = false;
+            feet.hasEmittedRing[ entry ][ side ] = false;
+            CI_LOG_I( "Foot up" );
+        }
+    }
+    if( !feet.isDown[ entry ][ side ] )
+    {
+        if( footPos.y < ( mFloorY + FootDownThresh ) )
+        {
+            if( feet.isUp[ entry ][ side ] )
+            {
+                const long long onset = findCrossing( feet.yPrevPos[ entry ][ side ], feet.yPrevVel[ entry ][ side ], footPos.y,
+                    mFloorY + FootDownThresh, timeStamp );
+                events.push_back( { DanceEvent::Type::FootStep, bodyId, footPos, onset, timeStamp } );
+                feet.hasEmittedRing[ entry ][ side ] = true;
+                CI_LOG_I( "Foot emit " + std::to_string( onset ) );
+            }
+            feet.isUp[ entry ][ side ] = false;
+            feet.isDown[ entry ][ side ] = true;
+            CI_LOG_I( "Foot down" );
+            if( hipY > calibration.standingHipY[ entry ] )
+            {
+                calibration.standingHipY[ entry ] = hipY;
+                calibration.standingKneeY[ entry ] = kneePos.y;
+            }
+            calibration.isKneeCalibrated[ entry ] = true;
+        }
+    }
+    feet.yPrevPos[ entry ][ side ] = footPos.y;
+    feet.yPrevVel[ entry ][ side ] = footVelocity;
+}
+
+void DanceDetector::detectKneeRaise(
+    size_t entry,
+    BodyTrackTable::Side side,
+    float kneeVelocity,
+    const ci::vec3 &kneePos,
+    uint64_t bodyId,
+    long long timeStamp,
+    std::vector<DanceEvent> &events
+)
+{
+    BodyTrackTable::Knees &knees = mTrackTable.knees;
+    const BodyTrackTable::Calibration &calibration = mTrackTable.calibration;
+    if( !calibration.isKneeCalibrated[ entry ] )
+    {
+        return;
+    }
+    // assymetry???
+    const float kneeUpThresh = ci::lerp( calibration.standingKneeY[ entry ], calibration.standingHipY[ entry ], 0.20f );
+    const float kneeDownThresh = ci::lerp( calibration.standingKneeY[ entry ], calibration.standingHipY[ entry ], 0.10f );
+
+    if( knees.isUp[ entry ][ side ] )
+    {
+        if( !knees.hasEmittedRing[ entry ][ side ] && ( kneeVelocity < KneeApexSpeed || kneePos.y < kneeDownThresh ) )
+        {
+            events.push_back( { DanceEvent::Type::KneeRaise, bodyId, kneePos, timeStamp, timeStamp } );
+            knees.hasEmittedRing[ entry ][ side ] = true;
+            CI_LOG_I( "Knee emit" );
+        }
+        if( kneePos.y < kneeDownThresh )
+        {
+            knees.isUp[ entry ][ side ] = false;
+            knees.hasEmittedRing[ entry ][ side ] = false;
+            CI_LOG_I( "Knee down" );
+        }
+    }
+    else
+    {
+        if( kneePos.y > kneeUpThresh )
+        {
+            knees.isUp[ entry ][ side ] = true;
+            CI_LOG_I( "Knee up" );
+        }
+    }
+}
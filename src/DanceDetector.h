@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <cinder/Vector.h>
+#include <Kinect2Frame.h>
+#include "BodyTrackTable.h"
+#include "SavitzkyGolayFilterBank.h"
+
+//! A step or knee raise found in a body frame. Positions are in Cinder
+//! space (x mirrored from the sensor), time stamps in sensor ticks.
+//! timeStamp is when the movement happened, which for a step lies between
+//! the previous frame and frameTimeStamp.
+struct DanceEvent
+{
+    enum class Type
+    {
+        FootStep,
+        KneeRaise
+    };
+
+    Type type{ Type::FootStep };
+    uint64_t bodyId{ 0 };
+    ci::vec3 pos{ 0.0f };
+    long long timeStamp{ 0 };
+    long long frameTimeStamp{ 0 };
+};
+
+//! Step and knee raise detection over a stream of body frames. Every frame
+//! passed to process() is treated as a new sensor sample, so callers must
+//! hand each frame in exactly once. Thresholds are in metres and seconds,
+//! and the sample period is measured from the time stamps, so sources
+//! faster than the Kinect's 30 Hz detect the same way.
+class DanceDetector
+{
+public:
+    //! Updates the floor estimate and appends the events found in \a frame.
+    DanceDetector();
+
+    void process( const Kinect2::BodyFrame &frame, std::vector<DanceEvent> &events );
+    //! Drops all per-body state and the floor estimate.
+    void reset();
+
+    float getFloorY() const;
+    bool hasFloorY() const;
+    //! Measured seconds between frames.
+    double getFramePeriod() const;
+    const BodyTrackTable &getTrackTable() const;
+
+    static ci::vec3 kinectToCinder( const ci::vec3 &pos );
+
+    static constexpr float FootUpThresh = 0.02f;
+    static constexpr float FootDownThresh = 0.01f;
+    //! Frame period assumed until one is measured, in seconds.
+    static constexpr double FramePeriod = 1.0 / 30.0;
+    //! Span of the joint smoothing window, in seconds.
+    static constexpr double FilterWindow = 0.2;
+    //! Slower descents (m/s) are interpolated between the frames instead.
+    static constexpr float MinOnsetSpeed = 0.05f;
+    //! A raised knee rising slower than this (m/s) is at the top.
+    static constexpr float KneeApexSpeed = 0.15f;
+
+private:
+    void estimateFloor( const Kinect2::Body &body );
+    //! Measures the frame period and resizes the filter when it changes.
+    void updateFramePeriod( long long timeStamp );
+    void filter( const Kinect2::Body &body, size_t entry, uint32_t generation, long long timeStamp );
+    void track( const Kinect2::Body &body, size_t entry, long long timeStamp, std::vector<DanceEvent> &events );
+    //! Time between the previous frame and \a timeStamp at which a joint
+    //! that was at \a prevY moving at \a prevVelocity (m/s), and is now at
+    //! \a y, crossed \a threshold.
+    long long findCrossing( float prevY, float prevVelocity, float y, float threshold, long long timeStamp ) const;
+    void detectFootStep(
+        size_t entry,
+        BodyTrackTable::Side side,
+        float footVelocity,
+        const ci::vec3 &footPos,
+        const ci::vec3 &kneePos,
+        float hipY,
+        uint64_t bodyId,
+        long long timeStamp,
+        std::vector<DanceEvent> &events
+    );
+    void detectKneeRaise(
+        size_t entry,
+        BodyTrackTable::Side side,
+        float kneeVelocity,
+        const ci::vec3 &kneePos,
+        uint64_t bodyId,
+        long long timeStamp,
+        std::vector<DanceEvent> &events
+    );
+
+    BodyTrackTable mTrackTable;
+    //! Joint positions per track table entry, in sensor space.
+    SavitzkyGolayFilterBank mFilterBank;
+    //! Generation and last time stamp each filter bank body was fed with.
+    uint32_t mFilterGenerations[ BodyTrackTable::Capacity ]{};
+    long long mFilterTimeStamps[ BodyTrackTable::Capacity ]{};
+    long long mPrevTimeStamp{ -1 };
+    //! The last frame intervals in ticks, for a median that ignores drops.
+    static constexpr size_t NumFrameIntervals = 16;
+    long long mFrameIntervals[ NumFrameIntervals ]{};
+    size_t mNumFrameIntervals{ 0 };
+    float mFloorY{ 1000.0f };
+    bool mHasFloorY{ false };
+};
+
+inline float DanceDetector::getFloorY() const { return mFloorY; }
+inline bool DanceDetector::hasFloorY() const { return mHasFloorY; }
+inline double DanceDetector::getFramePeriod() const { return mFilterBank.getOptions().timeStep(); }
+inline const BodyTrackTable &DanceDetector::getTrackTable() const { return mTrackTable; }
+inline ci::vec3 DanceDetector::kinectToCinder( const ci::vec3 &pos ) { return ci::vec3( -pos.x, pos.y, pos.z ); }
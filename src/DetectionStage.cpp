@@ -0,0 +1,99 @@
+#include "DetectionStage.h"
+
+DetectionStage::DetectionStage()
+{
+    mFloorY.store( mDetector.getFloorY(), std::memory_order_relaxed );
+}
+
+DetectionStage::~DetectionStage()
+{
+    stop();
+}
+
+void DetectionStage::start()
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    if( mRunning )
+    {
+        return;
+    }
+    mRunning = true;
+    mThread = std::thread( &DetectionStage::run, this );
+}
+
+void DetectionStage::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock( mMutex );
+        mRunning = false;
+    }
+    mCondition.notify_one();
+    if( mThread.joinable() )
+    {
+        mThread.join();
+    }
+}
+
+bool DetectionStage::push( const Kinect2::BodyFrame &frame )
+{
+    const long long timeStamp = frame.getTimeStamp();
+    {
+        std::lock_guard<std::mutex> lock( mMutex );
+        if( timeStamp <= mLastTimeStamp )
+        {
+            if( timeStamp > mLastTimeStamp - RestartTicks )
+            {
+                return false;
+            }
+            // The source rewound (looping replay, sensor reconnect).
+            mFrames.clear();
+            mResetPending = true;
+        }
+        mLastTimeStamp = timeStamp;
+        if( mFrames.size() >= MaxPendingFrames )
+        {
+            mFrames.pop_front();
+            mNumFramesDropped.fetch_add( 1, std::memory_order_relaxed );
+        }
+        mFrames.push_back( frame );
+    }
+    mCondition.notify_one();
+    return true;
+}
+
+void DetectionStage::popEvents( std::vector<DanceEvent> &events )
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    events.insert( events.end(), mEvents.begin(), mEvents.end() );
+    mEvents.clear();
+}
+
+void DetectionStage::run()
+{
+    std::unique_lock<std::mutex> lock( mMutex );
+    while( true )
+    {
+        mCondition.wait( lock, [this] { return !mRunning || !mFrames.empty(); } );
+        if( !mRunning )
+        {
+            break;
+        }
+        Kinect2::BodyFrame frame = std::move( mFrames.front() );
+        mFrames.pop_front();
+        const bool reset = mResetPending;
+        mResetPending = false;
+        lock.unlock();
+
+        if( reset )
+        {
+            mDetector.reset();
+        }
+        mFrameEvents.clear();
+        mDetector.process( frame, mFrameEvents );
+        mFloorY.store( mDetector.getFloorY(), std::memory_order_relaxed );
+        mNumFramesProcessed.fetch_add( 1, std::memory_order_relaxed );
+
+        lock.lock();
+        mEvents.insert( mEvents.end(), mFrameEvents.begin(), mFrameEvents.end() );
+    }
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "DanceDetector.h"
+
+//! Runs a DanceDetector on its own thread, driven by new sensor frames
+//! rather than the render loop. The render thread pushes each body frame
+//! as it arrives and drains the detected events once per update.
+class DetectionStage
+{
+public:
+    //! Frames queued beyond this are dropped, oldest first.
+    static constexpr size_t MaxPendingFrames = 8;
+    //! A time stamp further back than this means the source restarted (1 s).
+    static constexpr long long RestartTicks = 10000000LL;
+
+    DetectionStage();
+    ~DetectionStage();
+
+    DetectionStage( const DetectionStage & ) = delete;
+    DetectionStage &operator=( const DetectionStage & ) = delete;
+
+    void start();
+    void stop();
+
+    //! Queues \a frame unless it was already seen. Returns false for a
+    //! repeated or stale frame.
+    bool push( const Kinect2::BodyFrame &frame );
+    //! Moves all events detected since the last call into \a events.
+    void popEvents( std::vector<DanceEvent> &events );
+
+    float getFloorY() const;
+    size_t getNumFramesProcessed() const;
+    size_t getNumFramesDropped() const;
+
+private:
+    void run();
+
+    DanceDetector mDetector;
+    std::deque<Kinect2::BodyFrame> mFrames;
+    std::vector<DanceEvent> mEvents;
+    std::vector<DanceEvent> mFrameEvents;
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+    std::thread mThread;
+    bool mRunning{ false };
+    bool mResetPending{ false };
+    long long mLastTimeStamp{ -1 };
+
+    std::atomic<float> mFloorY{ 0.0f };
+    std::atomic<size_t> mNumFramesProcessed{ 0 };
+    std::atomic<size_t> mNumFramesDropped{ 0 };
+};
+
+inline float DetectionStage::getFloorY() const { return mFloorY.load( std::memory_order_relaxed ); }
+inline size_t DetectionStage::getNumFramesProcessed() const { return mNumFramesProcessed.load( std::memory_order_relaxed ); }
+inline size_t DetectionStage::getNumFramesDropped() const { return mNumFramesDropped.load( std::memory_order_relaxed ); }
@@ -5,29 +5,26 @@
 #include <cinder/Utilities.h>
 #include <cinder/CinderImGui.h>
 #include <cinder/Log.h>
-#include <cinder/Timeline.h>
-#include <cinder/Tween.h>
+#include <cinder/Timer.h>
+#include <cinder/gl/Query.h>
 #include <imgui/imgui_internal.h>
+#include <Kinect2Replay.h>
+#if defined( CINDER_MSW )
 #include <Kinect2.h>
+#endif
+#include "LinkTimeline.h"
 #include "LinkWrapper.h"
+#include "DetectionStage.h"
+#include "RingPool.h"
+#include "RingRenderer.h"
+#include "SensorOverlay.h"
 
 #include "fonts/RobotoRegular.h"
-#include "SavitzkyGolayFilter.h"
 
-struct AnimatedRing
+static bool hasArg( const std::vector<std::string> &args, const std::string &arg )
 {
-	ci::Anim<float> life{ 1.0f };
-	ci::vec3 pos{ 0.0f };
-	double beatFract{ 0.0 };
-	AnimatedRing( float bpm, const ci::vec3 &pos_, double beatFract_ )
-		: pos( pos_ )
-		, beatFract( beatFract_ )
-	{
-		const float startLife = ( 60.0f / bpm ) * 2;
-		CI_LOG_I( "StartLife " + std::to_string( startLife ) );
-		ci::app::timeline().apply( &life, 1.0f, 0.0f, startLife, ci::EaseOutQuad() );
-	}
-};
+	return std::find( args.begin(), args.end(), arg ) != args.end();
+}
 
 class HouseDancerApp : public ci::app::App
 {
@@ -37,72 +34,42 @@ public:
 	void update() override;
 
 private:
-	struct Foot
-	{
-		bool isUp{ false };
-		bool isDown{ true };
-		bool hasEmittedRing{ false };
-	};
-	struct Knee
-	{
-		bool isUp{ false };
-		bool hasEmittedRing{ false };
-		float yPrevPos{ 0.0f };
-		float yPrevVel{ 0.0f };
-	};
-	struct BodyTrackState
-	{
-		Foot lFoot;
-		Foot rFoot;
-		Knee lKnee;
-		Knee rKnee;
-		float standingKneeY{ 0.0f };
-		float standingHipY{ 0.0f };
-		bool isKneeCalibrated{ false };
-	};
-
 	void updateImGui();
-	void track( const Kinect2::Body &body );
-	void detectFootStep( 
-		const ci::vec3 &footPos,
-		const ci::vec3 &kneePos,
-		BodyTrackState &trackState,
-		Foot &foot,
-		Knee &knee,
-		float hipY 
-	);
-	void detectKneeRaise( BodyTrackState &trackState, const ci::vec3 &kneePos, Knee &knee );
-	void cleanupInactiveRings();
+	void emitRings();
 	void setupCamera();
+	void drawRings();
 	void drawRing( const ci::vec3 &pos, float scale, const ci::ColorAf &color );
+	void updateRingBenchmark();
 	static double fract( double );
-	static ci::vec3 kinectToCinder( const ci::vec3 &pos );
 	static ci::Colorf getRingColor( double fract );
+	static Kinect2::SourceRef createSource( const std::vector<std::string> &args );
+	void advanceSimulatedTime( long long sensorTicks );
 	bool hasTrackedBody() const;
 
 	Kinect2::BodyFrame mBodyFrame;
 	ci::Channel8uRef mChannelBodyIndex;
 	ci::Channel16uRef mChannelDepth;
-	Kinect2::DeviceRef mDevice;
+	// Depth and body index drawn from the raw channels on the GPU.
+	SensorOverlayRef mSensorOverlay;
+	Kinect2::SourceRef mSource;
+	Kinect2::RecordingWriterRef mRecordingWriter;
 	LinkWrapper mLinkWrapper;
+	// The session timeline, written beside --record and followed on --replay.
+	LinkTimelineRecorderRef mLinkTimelineRecorder;
+	LinkTimelinePlayerRef mLinkTimelinePlayer;
+	DetectionStage mDetectionStage;
+	std::vector<DanceEvent> mDanceEvents;
 
 	float mFrameRate;
 	bool mFullScreen;
+	size_t mNumBodyFrames{ 0 };
 	
 	ImFont *mFont{ nullptr };
 	//ImFont *mFontAwesomeTweaked{ nullptr };
 	static constexpr const int DefaultFontSize{ 20 };
 	int mFontSize{ DefaultFontSize };
 	
-	std::vector<std::unique_ptr<AnimatedRing>> mFootRings;
-	std::vector<std::unique_ptr<AnimatedRing>> mKneeRings;
-
-	std::map<uint64_t, ci::vec3> mPrevLeftFoot;
-	std::map<uint64_t, ci::vec3> mPrevRightFoot;
-	std::map<uint64_t, ci::vec3> mPrevLeftKnee;
-	std::map<uint64_t, ci::vec3> mPrevRightKnee;
-
-	std::unordered_map<uint64_t, BodyTrackState> mTrackStates;
+	RingPool mRings;
 
 	float mStepThreshold{ 0.15f };
 	float mKneeRaiseThreshold{ 0.2f };
@@ -110,22 +77,48 @@ private:
 	ci::gl::VertBatchRef mGridBatch;
 	ci::CameraPersp mCam;
 
-	float mFloorY{ 1000.0f };
-	bool mHasFloorY{ false };
 	ci::gl::BatchRef mRingBatch;
+	RingRendererRef mRingRenderer;
 	bool mHasTrackedBodies{ false };
-	static constexpr float FootUpThresh = 0.02f;
-	static constexpr float FootDownThresh = 0.01f;
+
+	// --simulate: Link time follows the replayed sensor time stamps and the
+	// beat follows a fixed-tempo timeline from the first frame, so a replay
+	// gives the same beats however fast it runs.
+	bool mIsSimulating{ false };
+	double mSimulatedTempo{ 120.0 };
+	std::atomic<long long> mSimulatedTime{ 0 };
+
+	// Ring benchmark: synthetic rings drawn on top of the detected ones,
+	// either instanced or one draw call each as before.
+	struct RingSweepResult
+	{
+		int numRings;
+		bool instanced;
+		double frameMs;
+	};
+	int mNumBenchmarkRings{ 0 };
+	bool mUseInstancedRings{ true };
+	ci::gl::QueryTimeSwappedRef mRingGpuTimer;
+	double mRingCpuMs{ 0.0 };
+	bool mIsRingSweepRunning{ false };
+	size_t mRingSweepStep{ 0 };
+	int mRingSweepFrame{ 0 };
+	double mRingSweepStartTime{ 0.0 };
+	std::vector<RingSweepResult> mRingSweepResults;
 };
 
-inline ci::vec3 HouseDancerApp::kinectToCinder( const ci::vec3 &pos )
-{
-	return ci::vec3( -pos.x, pos.y, pos.z );
-}
+// Rings fade out over this many beats, whatever the tempo does meanwhile.
+static constexpr float RingLifeBeats = 2.0f;
+// Ring counts the benchmark sweep steps through, each instanced and not.
+static const int RingSweepCounts[] = { 0, 100, 250, 500, 1000, 2000, 4000, 8000 };
+static constexpr size_t NumRingSweepSteps = 2 * ( sizeof( RingSweepCounts ) / sizeof( RingSweepCounts[ 0 ] ) );
+// Frames settled before timing, then frames timed, per step.
+static constexpr int RingSweepWarmupFrames = 10;
+static constexpr int RingSweepFrames = 60;
 
 inline double HouseDancerApp::fract( double f)
 {
-	return f - static_cast<long>( f );
+	return f - std::floor( f );
 }
 
 inline bool HouseDancerApp::hasTrackedBody() const
@@ -173,18 +166,14 @@ void HouseDancerApp::draw()
      {
 		 if( !hasTrackedBody() )
 		 {
-			 ci::gl::enable( GL_TEXTURE_2D );
-			 ci::gl::TextureRef tex = ci::gl::Texture::create( *Kinect2::channel16To8( mChannelDepth ) );
-			 ci::gl::draw( tex, tex->getBounds(), ci::Rectf( getWindowBounds() ) );
+			 mSensorOverlay->drawDepth( ci::Rectf( getWindowBounds() ) );
 		 }
 	 }
 
 	if ( mChannelBodyIndex ) 
     {
-		ci::gl::enable( GL_TEXTURE_2D );
 		ci::gl::color( ci::ColorAf( ci::Colorf::white(), 0.15f ) );
-		ci::gl::TextureRef tex = ci::gl::Texture::create( *Kinect2::colorizeBodyIndex( mChannelBodyIndex ) );
-		ci::gl::draw( tex, tex->getBounds(), ci::Rectf( getWindowBounds() ) );
+		mSensorOverlay->drawBodyIndex( ci::Rectf( getWindowBounds() ) );
 
 		
 		ci::gl::ScopedModelMatrix scopedMdlMtx;
@@ -195,16 +184,19 @@ void HouseDancerApp::draw()
 			if ( body.isTracked() ) 
             {
 				ci::gl::color( ci::ColorAf::white() );
-				for ( const auto& joint : body.getJointMap() ) 
+				for ( int j = 0; j < JointType_Count; ++j ) 
                 {
-					if ( joint.second.getTrackingState() == TrackingState::TrackingState_Tracked ) 
+					const JointType joint = static_cast<JointType>( j );
+					if ( body.hasJoint( joint ) && body.getJointTrackingState( joint ) == TrackingState::TrackingState_Tracked ) 
                     {
-						ci::vec2 pos( mDevice->mapCameraToDepth( joint.second.getPosition() ) );
+						ci::vec2 pos( mSource->mapCameraToDepth( body.getJointPosition( joint ) ) );
 						ci::gl::drawSolidCircle( pos, 5.0f, 32 );
-						ci::vec2 parent( mDevice->mapCameraToDepth(
-							body.getJointMap().at( joint.second.getParentJoint() ).getPosition()
-							) );
-						ci::gl::drawLine( pos, parent );
+						const JointType parentJoint = Kinect2::getParentJoint( joint );
+						if ( body.hasJoint( parentJoint ) )
+						{
+							ci::vec2 parent( mSource->mapCameraToDepth( body.getJointPosition( parentJoint ) ) );
+							ci::gl::drawLine( pos, parent );
+						}
 					}
 				}
 			}
@@ -221,49 +213,55 @@ void HouseDancerApp::draw()
 			ci::gl::ScopedLineWidth scopedLineWidth( 2.0f );
 			ci::gl::ScopedColor scopedColor( ci::Colorf::white() );
 			ci::gl::ScopedModelMatrix scopedModel;
-			ci::gl::translate( 0.0f, mFloorY * 1.0, 0.0f );
+			ci::gl::translate( 0.0f, mDetectionStage.getFloorY(), 0.0f );
 			mGridBatch->draw();
 		}
 
-		for( const Kinect2::Body &body : mBodyFrame.getBodies() )
-		{
-			auto const &jointMap = body.getJointMap();
-			if( body.isTracked() && !jointMap.empty() )
-			{
-				ci::vec3 leftFoot = jointMap.at( JointType_FootLeft ).getPosition();
-				ci::vec3 rightFoot = jointMap.at( JointType_FootRight ).getPosition();
-				leftFoot.x = -leftFoot.x;
-				rightFoot.x = -rightFoot.x;
+		drawRings();
+	}
+	updateRingBenchmark();
+}
 
-				//if( !mHasFloorY )
-				{
-					if( std::abs( leftFoot.y - rightFoot.y ) < 0.001 )
-					{
-						float floorY = std::min( leftFoot.y, rightFoot.y );
-						// or if floory is less than current floory
-						mFloorY = std::min( floorY, mFloorY );
-						mHasFloorY = true;
-					}
-				}
-			}// end if
-		}// end for
+void HouseDancerApp::drawRings()
+{
+	constexpr float startRingScale = 0.12f;
+	constexpr float endRingScale = 0.18f;
+	const double beat = mLinkWrapper.getSnapshot().beat;
+	mRingRenderer->clear();
+	mRings.forEach( beat, [&]( const ci::vec3 &pos, float life, double spawnBeat, DanceEvent::Type )
+	{
+		const float scale = ci::lerp<float>( 1.0f - life, endRingScale, startRingScale );
+		mRingRenderer->add( pos, scale, ci::ColorAf( getRingColor( fract( spawnBeat ) ), life ) );
+	} );
 
-		constexpr float startRingScale = 0.12f;
-		constexpr float endRingScale = 0.18f;
-		ci::gl::ScopedBlend blend( GL_SRC_ALPHA, GL_ONE );
-		for( const auto &ring : mFootRings )
-		{
-			const float alpha = ring->life.value();
-			const float scale = ci::lerp<float>( 1.0f - alpha, endRingScale, startRingScale );
-			drawRing( ring->pos, scale, ci::ColorAf( getRingColor( ring->beatFract ), alpha));
-		}
-		for( const auto &ring : mKneeRings )
-		{
-			const float alpha = ring->life.value();
-			const float scale = ci::lerp<float>( 1.0f - alpha, endRingScale, startRingScale );
-			drawRing( ring->pos, scale, ci::ColorAf( getRingColor( ring->beatFract ), alpha ) );
-		}
+	// Benchmark rings: a grid on the floor in front of the sensor, each
+	// pulsing on its own phase so they all change every frame.
+	const float floorY = mDetectionStage.getFloorY();
+	const int columns = static_cast<int>( std::ceil( std::sqrt( static_cast<float>( mNumBenchmarkRings ) ) ) );
+	for( int i = 0; i < mNumBenchmarkRings; ++i )
+	{
+		const float u = ( static_cast<float>( i % columns ) + 0.5f ) / static_cast<float>( columns );
+		const float v = ( static_cast<float>( i / columns ) + 0.5f ) / static_cast<float>( columns );
+		const float alpha = static_cast<float>( fract( beat * 0.25 + i * 0.618 ) );
+		const float scale = ci::lerp<float>( 1.0f - alpha, endRingScale, startRingScale );
+		const ci::vec3 pos( ci::lerp( -2.5f, 2.5f, u ), floorY, ci::lerp( 1.5f, 4.5f, v ) );
+		mRingRenderer->add( pos, scale, ci::ColorAf( getRingColor( fract( i * 0.25 ) ), alpha ) );
+	}
+
+	ci::gl::ScopedBlend blend( GL_SRC_ALPHA, GL_ONE );
+	ci::Timer cpuTimer( true );
+	mRingGpuTimer->begin();
+	if( mUseInstancedRings )
+	{
+		mRingRenderer->draw();
 	}
+	else
+	{
+		// The old path, one batch draw per ring, kept for comparison.
+		mRingRenderer->forEach( [this]( const ci::vec3 &pos, float scale, const ci::ColorAf &color ) { drawRing( pos, scale, color ); } );
+	}
+	mRingGpuTimer->end();
+	mRingCpuMs = cpuTimer.getSeconds() * 1000.0;
 }
 
 void HouseDancerApp::setup()
@@ -271,23 +269,88 @@ void HouseDancerApp::setup()
 	mFrameRate	= 0.0f;
 	mFullScreen	= false;
 
-	mDevice = Kinect2::Device::create();
-	mDevice->start();
-	mDevice->connectBodyEventHandler( [this]( const Kinect2::BodyFrame frame )
+	mSensorOverlay = SensorOverlay::create();
+	const auto &args = getCommandLineArgs();
+	mSource = createSource( args );
+	const auto recordArg = std::find( args.begin(), args.end(), "--record" );
+	if( recordArg != args.end() && ( recordArg + 1 ) != args.end() )
 	{
-		mBodyFrame = frame;
-	} );
-	mDevice->connectBodyIndexEventHandler( [this]( const Kinect2::BodyIndexFrame frame )
+		mRecordingWriter = Kinect2::RecordingWriter::create( *( recordArg + 1 ) );
+		mLinkTimelineRecorder = LinkTimelineRecorder::create( mLinkWrapper, *( recordArg + 1 ) + ".link" );
+	}
+	const auto replayArg = std::find( args.begin(), args.end(), "--replay" );
+	if( mSource && replayArg != args.end() && ( replayArg + 1 ) != args.end() && ci::fs::exists( *( replayArg + 1 ) + ".link" ) )
 	{
-		mChannelBodyIndex = frame.getChannel();
-	} );
-	 mDevice->connectDepthEventHandler( [this]( const Kinect2::DepthFrame frame )
-	 {
-		if( !hasTrackedBody() )
+		mLinkTimelinePlayer = LinkTimelinePlayer::create( *( replayArg + 1 ) + ".link" );
+	}
+	if( mSource && hasArg( args, "--simulate" ) )
+	{
+		mIsSimulating = true;
+		const auto bpmArg = std::find( args.begin(), args.end(), "--bpm" );
+		if( bpmArg != args.end() && ( bpmArg + 1 ) != args.end() && std::atof( ( bpmArg + 1 )->c_str() ) > 0.0 )
 		{
-	 		mChannelDepth = frame.getChannel();
+			mSimulatedTempo = std::atof( ( bpmArg + 1 )->c_str() );
 		}
-	 } );
+		mLinkWrapper.setClock( [this] { return std::chrono::microseconds( mSimulatedTime.load( std::memory_order_relaxed ) ); } );
+	}
+	if( mSource )
+	{
+		// Arrival is timed on the capture thread, so render load does not
+		// move the sensor clock fit.
+		mSource->setArrivalClock( [this] { return mLinkWrapper.getHostTime().count(); } );
+		mDetectionStage.start();
+		mSource->start();
+		mSource->connectBodyEventHandler( [this]( const Kinect2::BodyFrame frame )
+		{
+			if( mIsSimulating )
+			{
+				advanceSimulatedTime( frame.getTimeStamp() );
+			}
+			mBodyFrame = frame;
+			++mNumBodyFrames;
+			if( mDetectionStage.push( frame ) )
+			{
+				if( mIsSimulating )
+				{
+					// The simulated clock was just moved to this frame.
+					mLinkWrapper.addSensorTime( frame.getTimeStamp() );
+				}
+				else
+				{
+					mLinkWrapper.addSensorTime( frame.getTimeStamp(), std::chrono::microseconds( frame.getArrivalTime() ) );
+				}
+			}
+			if( mLinkTimelinePlayer && mLinkWrapper.hasSensorTime() )
+			{
+				mLinkTimelinePlayer->update( mLinkWrapper, frame.getTimeStamp() );
+			}
+			if( mRecordingWriter )
+			{
+				mRecordingWriter->writeBodyFrame( frame );
+			}
+		} );
+		mSource->connectBodyIndexEventHandler( [this]( const Kinect2::BodyIndexFrame frame )
+		{
+			mChannelBodyIndex = frame.getChannel();
+			mSensorOverlay->setBodyIndex( mChannelBodyIndex );
+			if( mRecordingWriter )
+			{
+				mRecordingWriter->writeBodyIndexFrame( frame );
+			}
+		} );
+		mSource->connectDepthEventHandler( [this]( const Kinect2::DepthFrame frame )
+		{
+			if( mRecordingWriter )
+			{
+				mRecordingWriter->writeDepthFrame( frame );
+			}
+			if( !hasTrackedBody() )
+			{
+				mChannelDepth = frame.getChannel();
+				mSensorOverlay->setDepth( mChannelDepth );
+			}
+		} );
+	}
 	
 	ImGui::Initialize();
 	ImFontConfig fontConfig;
@@ -314,6 +377,39 @@ void HouseDancerApp::setup()
 		.subdivisions( 64 )
 		;
 	mRingBatch = ci::gl::Batch::create( ring, ci::gl::getStockShader( ci::gl::ShaderDef().color() ) );
+	mRingRenderer = RingRenderer::create( 1.0f, 0.2f );
+	mRingGpuTimer = ci::gl::QueryTimeSwapped::create();
+}
+
+Kinect2::SourceRef HouseDancerApp::createSource( const std::vector<std::string> &args )
+{
+	// --replay <file> plays a recording instead of opening the sensor.
+	// --unthrottled feeds one body frame per app tick as fast as possible.
+	// --simulate [--bpm <tempo>] is --unthrottled on a virtual clock.
+	// A <file>.link session timeline beside the recording sets the beat.
+	const auto replayArg = std::find( args.begin(), args.end(), "--replay" );
+	if( replayArg != args.end() && ( replayArg + 1 ) != args.end() )
+	{
+		const bool realTime = !hasArg( args, "--unthrottled" ) && !hasArg( args, "--simulate" );
+		const bool loop = hasArg( args, "--loop" );
+		return Kinect2::Replay::create( *( replayArg + 1 ), realTime, loop );
+	}
+#if defined( CINDER_MSW )
+	// Only the lower-body joint positions feed tracking and the skeleton overlay.
+	Kinect2::DeviceRef device = Kinect2::Device::create();
+	uint32_t jointMask = 0;
+	for( JointType joint : { JointType_SpineBase, JointType_HipLeft, JointType_HipRight,
+		JointType_KneeLeft, JointType_KneeRight, JointType_AnkleLeft, JointType_AnkleRight,
+		JointType_FootLeft, JointType_FootRight } )
+	{
+		jointMask |= 1u << joint;
+	}
+	device->setBodyFeatures( Kinect2::Device::BodyFeature_Joints, jointMask );
+	return device;
+#else
+	CI_LOG_E( "No Kinect sensor on this platform, use --replay <file>" );
+	return nullptr;
+#endif
 }
 
 void HouseDancerApp::drawRing( const ci::vec3 &pos, float scale, const ci::ColorAf &color )
@@ -328,6 +424,37 @@ void HouseDancerApp::drawRing( const ci::vec3 &pos, float scale, const ci::Color
 	mRingBatch->draw();
 }
 
+void HouseDancerApp::updateRingBenchmark()
+{
+	if( !mIsRingSweepRunning )
+	{
+		return;
+	}
+	// Steps alternate per ring and instanced at each count; every step
+	// times whole frames, so the rest of draw() is in the baseline.
+	const RingSweepResult step = { RingSweepCounts[ mRingSweepStep / 2 ], mRingSweepStep % 2 == 1, 0.0 };
+	mNumBenchmarkRings = step.numRings;
+	mUseInstancedRings = step.instanced;
+	++mRingSweepFrame;
+	if( mRingSweepFrame == RingSweepWarmupFrames )
+	{
+		mRingSweepStartTime = getElapsedSeconds();
+	}
+	else if( mRingSweepFrame == RingSweepWarmupFrames + RingSweepFrames )
+	{
+		const double frameMs = ( getElapsedSeconds() - mRingSweepStartTime ) * 1000.0 / RingSweepFrames;
+		mRingSweepResults.push_back( { step.numRings, step.instanced, frameMs } );
+		mRingSweepFrame = 0;
+		if( ++mRingSweepStep == NumRingSweepSteps )
+		{
+			mIsRingSweepRunning = false;
+			mNumBenchmarkRings = 0;
+			mUseInstancedRings = true;
+			ci::gl::enableVerticalSync( true );
+		}
+	}
+}
+
 void HouseDancerApp::update()
 {
 	mFrameRate = getAverageFps();
@@ -338,16 +465,17 @@ void HouseDancerApp::update()
 		mFullScreen = isFullScreen();
 	}
 
-	if( mDevice )
+	// One session capture for the whole frame: everything drawn and shown
+	// runs on this beat.
+	const LinkWrapper::Snapshot &link = mLinkWrapper.captureSnapshot();
+	if( mLinkTimelineRecorder )
 	{
-		for( const auto &body : mBodyFrame.getBodies() ) 
-		{
-			if( body.isTracked() )
-			{
-				track( body );
-			}
-		}
-		cleanupInactiveRings();
+		mLinkTimelineRecorder->update();
+	}
+	if( mSource )
+	{
+		emitRings();
+		mRings.expire( link.beat );
 	}
 
 	updateImGui();
@@ -359,6 +487,32 @@ void HouseDancerApp::updateImGui()
 
 	ImGui::Begin( "Controls" );
 	ImGui::Text( "Frame Rate: %.2f", mFrameRate );
+	ImGui::Text( "Body Frames: %zu", mNumBodyFrames );
+	ImGui::Text( "Detection: %zu frames, %zu dropped", mDetectionStage.getNumFramesProcessed(), mDetectionStage.getNumFramesDropped() );
+#if defined( CINDER_MSW )
+	if( auto device = std::dynamic_pointer_cast<Kinect2::Device>( mSource ) )
+	{
+		static const std::pair<Kinect2::Device::FrameType, const char *> streams[] = {
+			{ Kinect2::Device::FrameType_Body, "Body" },
+			{ Kinect2::Device::FrameType_BodyIndex, "Body Index" },
+			{ Kinect2::Device::FrameType_Depth, "Depth" }
+		};
+		for( const auto &stream : streams )
+		{
+			const Kinect2::Device::StreamStats stats = device->getStreamStats( stream.first );
+			ImGui::Text( "%s: %llu in, %llu out, %llu dropped", stream.second,
+				static_cast<unsigned long long>( stats.getNumFramesProduced() ),
+				static_cast<unsigned long long>( stats.getNumFramesDelivered() ),
+				static_cast<unsigned long long>( stats.getNumFramesDropped() ) );
+			const Kinect2::FramePoolStats &pool = stats.getPoolStats();
+			if( pool.getCapacity() > 0 )
+			{
+				ImGui::Text( "%s Buffers: %zu/%zu in use, %zu allocated", stream.second,
+					pool.getNumInUse(), pool.getCapacity(), pool.getNumAllocated() );
+			}
+		}
+	}
+#endif
 	ImGui::Checkbox( "Is FullScreen", &mFullScreen );
 	ImGui::Text( "Peers: %d", mLinkWrapper.getNumPeers() );
 	if( ImGui::Button( "Connect" ) )
@@ -366,146 +520,88 @@ void HouseDancerApp::updateImGui()
 		mLinkWrapper.setIsEnabled( true );
 	}
 
-	double phase = 0.0;
-	const float beat = mLinkWrapper.getBeatAndPhase( phase );
-	const double tempo = mLinkWrapper.getTempo();
-	ImGui::Text( "Tempo: %.2f", tempo );
-	ImGui::Text( "Beat: %.2f", beat );
-	ImGui::Text( "Phase: %.2f", phase );
-
-	ImGui::End();
-
-	auto *drawList = ImGui::GetBackgroundDrawList();
-	const std::string text = std::to_string( static_cast<int>( mLinkWrapper.getTempo() ) ) + " : " + 
-		                     std::to_string( static_cast<int>( mLinkWrapper.getPhase() ) + 1 );
-	drawList->AddText( mFont, 80, ImVec2( getWindowWidth() - ImGui::GetFontSize() * 10,  0 ), IM_COL32_WHITE, text.c_str() );
-}
-
-void HouseDancerApp::detectFootStep( 
-	const ci::vec3 &footPos,
-	const ci::vec3 &kneePos,
-	BodyTrackState &trackState,
-	Foot &foot,
-	Knee &knee,
-	float hipY
-)
-{
-	if( !foot.isUp )
-	{
-		if( footPos.y > ( mFloorY + FootUpThresh ) )
-		{
-			foot.isUp = true;
-			foot.isDown = false;
-			foot.hasEmittedRing = false;
-			CI_LOG_I( "Foot up" );
-		}
-	}
-	if( !foot.isDown )
+	const LinkWrapper::Snapshot &link = mLinkWrapper.getSnapshot();
+	ImGui::Text( "Tempo: %.2f", link.tempo );
+	ImGui::Text( "Beat: %.2f", link.beat );
+	ImGui::Text( "Phase: %.2f", link.phase );
+	int sensorLatencyMs = static_cast<int>( mLinkWrapper.getSensorLatency().count() / 1000 );
+	if( ImGui::SliderInt( "Sensor Latency (ms)", &sensorLatencyMs, 0, 200 ) )
 	{
-		if( footPos.y < ( mFloorY + FootDownThresh ) )
-		{
-			if( foot.isUp )
-			{
-				mFootRings.push_back( std::make_unique<AnimatedRing>( mLinkWrapper.getTempo(), footPos, fract( mLinkWrapper.getBeat() ) ) );
-				foot.hasEmittedRing = true;
-				CI_LOG_I( "Foot emit " + std::to_string( ci::app::getElapsedFrames() ) );
-			}
-			foot.isUp = false;
-			foot.isDown = true;
-			CI_LOG_I( "Foot down" );
-			//if( trackState.mStandingKneeY < ci::EPSILON_VALUE )
-			{
-				if( hipY > trackState.standingHipY )
-				{
-					trackState.standingHipY = hipY;
-					trackState.standingKneeY = kneePos.y;
-				}
-				trackState.isKneeCalibrated = true;
-			}
-		}
+		mLinkWrapper.setSensorLatency( std::chrono::milliseconds( sensorLatencyMs ) );
 	}
-}
-
-void HouseDancerApp::detectKneeRaise( BodyTrackState &trackState, const ci::vec3 &kneePos, Knee &knee )
-{
-	if( !trackState.isKneeCalibrated )
+	float depthWindow[ 2 ] = { mSensorOverlay->getDepthNear(), mSensorOverlay->getDepthFar() };
+	if( ImGui::DragFloat2( "Depth Window (mm)", depthWindow, 10.0f, 0.0f, 8000.0f, "%.0f" ) )
 	{
-		return;
+		mSensorOverlay->setDepthWindow( depthWindow[ 0 ], depthWindow[ 1 ] );
 	}
-	// assymetry???
-	const float kneeUpThresh = ci::lerp( trackState.standingKneeY, trackState.standingHipY, 0.20f );
-	const float kneeDownThresh = ci::lerp( trackState.standingKneeY, trackState.standingHipY, 0.10f );
 
-	if( knee.isUp )
+	if( ImGui::CollapsingHeader( "Ring Benchmark" ) )
 	{
-		constexpr float KneeVelThresh = 0.005f;
-		const float vel = kneePos.y - knee.yPrevPos;
-		if( !knee.hasEmittedRing && ( vel < KneeVelThresh || kneePos.y < kneeDownThresh ) )//vel < 0.0f && knee.yPrevVel < 0.0f )
+		ImGui::Checkbox( "Instanced", &mUseInstancedRings );
+		ImGui::SliderInt( "Extra Rings", &mNumBenchmarkRings, 0, 10000 );
+		ImGui::Text( "Rings: %zu, CPU %.3f ms, GPU %.3f ms", mRingRenderer->getNumRings(), mRingCpuMs,
+			mRingGpuTimer->getElapsedMilliseconds() );
+		if( !mIsRingSweepRunning && ImGui::Button( "Run Sweep" ) )
 		{
-			// emit ring;
-			mKneeRings.push_back( std::make_unique<AnimatedRing>( mLinkWrapper.getTempo(), kneePos, fract( mLinkWrapper.getBeat() ) ) );
-			knee.hasEmittedRing = true;
-			CI_LOG_I( "Knee emit" );
+			// Vsync would pin every step to the refresh rate.
+			ci::gl::enableVerticalSync( false );
+			mRingSweepResults.clear();
+			mRingSweepStep = 0;
+			mRingSweepFrame = 0;
+			mIsRingSweepRunning = true;
 		}
-		knee.yPrevVel = vel;
-		if( kneePos.y < kneeDownThresh )
+		if( mIsRingSweepRunning )
 		{
-			knee.isUp = false;
-			knee.hasEmittedRing = false;
-			knee.yPrevVel = 0.0f;
-			knee.yPrevPos = 0.0f;
-			CI_LOG_I( "Knee down" );
+			ImGui::Text( "Sweeping %zu/%zu", mRingSweepStep + 1, NumRingSweepSteps );
 		}
-	}
-	else
-	{
-		if( kneePos.y > kneeUpThresh )
+		// Whole frame times, per ring draw calls against one instanced call.
+		for( size_t i = 0; i + 1 < mRingSweepResults.size(); i += 2 )
 		{
-			knee.isUp = true;
-			knee.yPrevVel = 0.0f;
-			knee.yPrevPos = kneePos.y;
-			CI_LOG_I( "Knee up" );
+			ImGui::Text( "%5d rings: %7.2f ms, instanced %7.2f ms", mRingSweepResults[ i ].numRings,
+				mRingSweepResults[ i ].frameMs, mRingSweepResults[ i + 1 ].frameMs );
 		}
 	}
-}
 
-void HouseDancerApp::track( const Kinect2::Body &body )
-{
-	uint64_t trackingId = body.getId();
+	ImGui::End();
 
-	// Get foot positions
-	auto const &jointMap = body.getJointMap();
-	const ci::vec3 &leftFootPos = kinectToCinder( jointMap.at( JointType_FootLeft ).getPosition() );
-	const ci::vec3 &rightFootPos = kinectToCinder( jointMap.at( JointType_FootRight ).getPosition() );
-	const ci::vec3 &leftKneePos = kinectToCinder( jointMap.at( JointType_KneeLeft ).getPosition() );
-	const ci::vec3 &rightKneePos = kinectToCinder( jointMap.at( JointType_KneeRight ).getPosition() );
-	const ci::vec3 &leftHipPos = kinectToCinder( jointMap.at( JointType_HipLeft ).getPosition() );
-	const ci::vec3 &rightHipPos = kinectToCinder( jointMap.at( JointType_HipRight ).getPosition() );
+	auto *drawList = ImGui::GetBackgroundDrawList();
+	const std::string text = std::to_string( static_cast<int>( link.tempo ) ) + " : " + 
+		                     std::to_string( static_cast<int>( link.phase ) + 1 );
+	drawList->AddText( mFont, 80, ImVec2( getWindowWidth() - ImGui::GetFontSize() * 10,  0 ), IM_COL32_WHITE, text.c_str() );
+}
 
-	//CI_LOG_I( "Left foot: "  + std::to_string(leftFoot.x) + " " + std::to_string( leftFoot.y ) + " " + std::to_string( leftFoot.z ) );
-	auto iter = mTrackStates.find( body.getId() );
-	if( iter == mTrackStates.end() )
+void HouseDancerApp::emitRings()
+{
+	mDanceEvents.clear();
+	mDetectionStage.popEvents( mDanceEvents );
+	if( mDanceEvents.empty() )
 	{
-		iter = mTrackStates.emplace( body.getId(), BodyTrackState() ).first;
+		return;
+	}
+	const LinkWrapper::Snapshot &link = mLinkWrapper.getSnapshot();
+	for( const DanceEvent &event : mDanceEvents )
+	{
+		// Start on the beat the movement happened on, not the one it was
+		// drawn on: sensor, transfer and detection latency are taken out.
+		const double beat = link.beatAtTime( mLinkWrapper.sensorTimeToHostTime( event.timeStamp ) );
+		mRings.spawn( beat, RingLifeBeats, event.pos, event.type );
 	}
-	auto &trackState = iter->second;
-
-	detectFootStep( leftFootPos, leftKneePos, trackState, trackState.lFoot, trackState.lKnee, leftHipPos.y );
-	detectFootStep( rightFootPos, rightKneePos, trackState, trackState.rFoot, trackState.rKnee, rightHipPos.y );
-	detectKneeRaise( trackState, leftKneePos, trackState.lKnee );
-	detectKneeRaise( trackState, rightKneePos, trackState.rKnee );
 }
 
-void HouseDancerApp::cleanupInactiveRings()
+void HouseDancerApp::advanceSimulatedTime( long long sensorTicks )
 {
-	mFootRings.erase(
-		std::remove_if( mFootRings.begin(), mFootRings.end(),
-			[] ( const std::unique_ptr<AnimatedRing> &ring ) { return ring->life < ci::EPSILON_VALUE; } ),
-		mFootRings.end() );
-	mKneeRings.erase(
-		std::remove_if( mKneeRings.begin(), mKneeRings.end(),
-			[] ( const std::unique_ptr<AnimatedRing> &ring ) { return ring->life < ci::EPSILON_VALUE; } ),
-		mKneeRings.end() );
+	// Sensor ticks are 100 ns; the frame is taken to arrive as it is stamped.
+	const std::chrono::microseconds time( sensorTicks / 10 );
+	mSimulatedTime.store( time.count(), std::memory_order_relaxed );
+	// A recorded session timeline, when there is one, is played instead.
+	if( !mLinkTimelinePlayer && !mLinkWrapper.hasTimeline() )
+	{
+		LinkWrapper::Snapshot timeline;
+		timeline.hostTime = time;
+		timeline.tempo = mSimulatedTempo;
+		timeline.isPlaying = true;
+		mLinkWrapper.setTimeline( timeline );
+	}
 }
 
 void HouseDancerApp::setupCamera()
@@ -526,5 +622,12 @@ void HouseDancerApp::setupCamera()
 CINDER_APP( HouseDancerApp, ci::app::RendererGl, []( ci::app::App::Settings* settings )
 {
 	settings->prepareWindow( ci::app::Window::Format().size( 1024, 768 ).title( "House Dancer App" ) );
-	settings->setFrameRate( 60.0f );
+	if( hasArg( settings->getCommandLineArgs(), "--unthrottled" ) || hasArg( settings->getCommandLineArgs(), "--simulate" ) )
+	{
+		settings->disableFrameRate();
+	}
+	else
+	{
+		settings->setFrameRate( 60.0f );
+	}
 } )
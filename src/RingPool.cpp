@@ -0,0 +1,69 @@
+#include "RingPool.h"
+
+RingPool::RingPool( size_t capacity )
+    : mSpawnBeats( capacity )
+    , mInvDurations( capacity )
+    , mPositions( capacity )
+    , mKinds( capacity )
+{
+}
+
+void RingPool::spawn( double beat, float duration, const ci::vec3 &pos, DanceEvent::Type kind )
+{
+    if( getCapacity() == 0 || duration <= 0.0f )
+    {
+        return;
+    }
+    if( mNumRings == getCapacity() )
+    {
+        // Only on overflow: a linear search for the earliest end.
+        size_t oldest = 0;
+        double oldestEnd = mSpawnBeats[ 0 ] + 1.0 / mInvDurations[ 0 ];
+        for( size_t i = 1; i < mNumRings; ++i )
+        {
+            const double end = mSpawnBeats[ i ] + 1.0 / mInvDurations[ i ];
+            if( end < oldestEnd )
+            {
+                oldest = i;
+                oldestEnd = end;
+            }
+        }
+        remove( oldest );
+    }
+    const size_t index = mNumRings++;
+    mSpawnBeats[ index ] = beat;
+    mInvDurations[ index ] = 1.0f / duration;
+    mPositions[ index ] = pos;
+    mKinds[ index ] = static_cast<uint8_t>( kind );
+}
+
+void RingPool::expire( double beat )
+{
+    size_t i = 0;
+    while( i < mNumRings )
+    {
+        const float age = getAge( i, beat );
+        if( age >= 1.0f || age < -1.0f )
+        {
+            remove( i );
+        }
+        else
+        {
+            ++i;
+        }
+    }
+}
+
+void RingPool::clear()
+{
+    mNumRings = 0;
+}
+
+void RingPool::remove( size_t index )
+{
+    const size_t last = --mNumRings;
+    mSpawnBeats[ index ] = mSpawnBeats[ last ];
+    mInvDurations[ index ] = mInvDurations[ last ];
+    mPositions[ index ] = mPositions[ last ];
+    mKinds[ index ] = mKinds[ last ];
+}
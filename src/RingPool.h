@@ -0,0 +1,64 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <cinder/Vector.h>
+#include "DanceDetector.h"
+
+//! Fixed-capacity store of live rings, one array per attribute. A ring only
+//! records the beat it was spawned on and for how many beats it lives; its
+//! life is worked out from the current beat whenever it is drawn, so rings
+//! stay locked to the music through tempo changes and nothing animates them
+//! in between. spawn() and expire() never allocate.
+class RingPool
+{
+public:
+    static constexpr size_t DefaultCapacity = 4096;
+
+    explicit RingPool( size_t capacity = DefaultCapacity );
+
+    //! Adds a ring living \a duration beats from \a beat. When the pool is
+    //! full the ring closest to expiring makes room.
+    void spawn( double beat, float duration, const ci::vec3 &pos, DanceEvent::Type kind );
+    //! Drops rings whose life has ended by \a beat, and any spawned more
+    //! than a lifetime after it, which only happens when the session
+    //! timeline jumps back. Order is not kept.
+    void expire( double beat );
+    void clear();
+
+    //! Calls \a fn( pos, life, spawnBeat, kind ) for every ring at \a beat,
+    //! life going from 1 at spawn to 0 at expiry.
+    template<typename FnT>
+    void forEach( double beat, FnT fn ) const;
+
+    size_t getNumRings() const;
+    size_t getCapacity() const;
+
+private:
+    //! Fraction of its life ring \a index has lived at \a beat.
+    float getAge( size_t index, double beat ) const;
+    void remove( size_t index );
+
+    size_t mNumRings{ 0 };
+    std::vector<double> mSpawnBeats;
+    std::vector<float> mInvDurations;
+    std::vector<ci::vec3> mPositions;
+    std::vector<uint8_t> mKinds;
+};
+
+inline size_t RingPool::getNumRings() const { return mNumRings; }
+inline size_t RingPool::getCapacity() const { return mSpawnBeats.size(); }
+inline float RingPool::getAge( size_t index, double beat ) const { return static_cast<float>( beat - mSpawnBeats[ index ] ) * mInvDurations[ index ]; }
+
+template<typename FnT>
+void RingPool::forEach( double beat, FnT fn ) const
+{
+    for( size_t i = 0; i < mNumRings; ++i )
+    {
+        // The ease-out quad the rings used to be tweened with, 1 - t( 2 - t ).
+        const float u = 1.0f - std::min( std::max( getAge( i, beat ), 0.0f ), 1.0f );
+        fn( mPositions[ i ], u * u, mSpawnBeats[ i ], static_cast<DanceEvent::Type>( mKinds[ i ] ) );
+    }
+}
@@ -0,0 +1,97 @@
+#include "RingRenderer.h"
+#include <cstddef>
+#include <cinder/GeomIo.h>
+#include <cinder/gl/GlslProg.h>
+#include <cinder/gl/VboMesh.h>
+
+namespace
+{
+
+const char *RingVertexShader = R"(
+#version 150
+uniform mat4 ciModelViewProjection;
+in vec4 ciPosition;
+in vec4 iPositionScale;
+in vec4 iColor;
+out vec2 vLocal;
+out vec4 vColor;
+void main()
+{
+    vLocal = ciPosition.xz;
+    vColor = iColor;
+    gl_Position = ciModelViewProjection * vec4( iPositionScale.xyz + ciPosition.xyz * iPositionScale.w, 1.0 );
+}
+)";
+
+const char *RingFragmentShader = R"(
+#version 150
+uniform float uRadius;
+uniform float uHalfWidth;
+in vec2 vLocal;
+in vec4 vColor;
+out vec4 oColor;
+void main()
+{
+    // Distance to the ring's edge, negative inside; one pixel of coverage
+    // ramp either side keeps it antialiased at any scale.
+    float d = abs( length( vLocal ) - uRadius ) - uHalfWidth;
+    float aa = fwidth( d );
+    float coverage = 1.0 - smoothstep( -aa, aa, d );
+    if( coverage <= 0.0 )
+    {
+        discard;
+    }
+    oColor = vec4( vColor.rgb, vColor.a * coverage );
+}
+)";
+
+// Instances the buffer starts out with room for; it grows as needed.
+constexpr size_t InitialCapacity = 256;
+
+} // namespace
+
+RingRendererRef RingRenderer::create( float radius, float width )
+{
+    return RingRendererRef( new RingRenderer( radius, width ) );
+}
+
+RingRenderer::RingRenderer( float radius, float width )
+{
+    mInstances.reserve( InitialCapacity );
+    mInstanceVbo = ci::gl::Vbo::create( GL_ARRAY_BUFFER, InitialCapacity * sizeof( Instance ), nullptr, GL_STREAM_DRAW );
+
+    ci::geom::BufferLayout layout;
+    layout.append( ci::geom::Attrib::CUSTOM_0, 4, sizeof( Instance ), offsetof( Instance, positionScale ), 1 );
+    layout.append( ci::geom::Attrib::CUSTOM_1, 4, sizeof( Instance ), offsetof( Instance, color ), 1 );
+
+    // Just big enough for the outer edge plus a pixel or so of ramp.
+    const float extent = radius + width;
+    ci::gl::VboMeshRef mesh = ci::gl::VboMesh::create( ci::geom::Plane().size( ci::vec2( 2.0f * extent ) ) );
+    mesh->appendVbo( layout, mInstanceVbo );
+
+    ci::gl::GlslProgRef glsl = ci::gl::GlslProg::create( ci::gl::GlslProg::Format().vertex( RingVertexShader ).fragment( RingFragmentShader ) );
+    glsl->uniform( "uRadius", radius );
+    glsl->uniform( "uHalfWidth", 0.5f * width );
+    mBatch = ci::gl::Batch::create( mesh, glsl, { { ci::geom::Attrib::CUSTOM_0, "iPositionScale" }, { ci::geom::Attrib::CUSTOM_1, "iColor" } } );
+}
+
+void RingRenderer::clear()
+{
+    mInstances.clear();
+}
+
+void RingRenderer::add( const ci::vec3 &pos, float scale, const ci::ColorAf &color )
+{
+    mInstances.push_back( { ci::vec4( pos, scale ), color } );
+}
+
+void RingRenderer::draw()
+{
+    if( mInstances.empty() )
+    {
+        return;
+    }
+    // Orphans last frame's storage, so the upload never waits on the GPU.
+    mInstanceVbo->bufferData( mInstances.size() * sizeof( Instance ), mInstances.data(), GL_STREAM_DRAW );
+    mBatch->drawInstanced( static_cast<GLsizei>( mInstances.size() ) );
+}
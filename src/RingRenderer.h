@@ -0,0 +1,59 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <cinder/Color.h>
+#include <cinder/Vector.h>
+#include <cinder/gl/Batch.h>
+#include <cinder/gl/Vbo.h>
+
+typedef std::shared_ptr<class RingRenderer> RingRendererRef;
+
+//! Draws any number of floor rings in a single instanced draw call. Each
+//! ring is one quad on the XZ plane; the fragment shader cuts the ring out
+//! of it analytically, so the cost no longer depends on tessellation. Ring
+//! attributes are collected with add() and uploaded once per draw().
+class RingRenderer
+{
+public:
+    //! \a radius is the centre line of the ring, \a width its thickness,
+    //! both before scaling. Needs a current GL context.
+    static RingRendererRef create( float radius = 1.0f, float width = 0.2f );
+
+    void clear();
+    void add( const ci::vec3 &pos, float scale, const ci::ColorAf &color );
+    //! Draws every ring added since clear() with the current matrices and
+    //! blend state.
+    void draw();
+
+    //! Calls \a fn( pos, scale, color ) for every ring added.
+    template<typename FnT>
+    void forEach( FnT fn ) const;
+
+    size_t getNumRings() const;
+
+private:
+    RingRenderer( float radius, float width );
+
+    struct Instance
+    {
+        //! xyz position, w scale.
+        ci::vec4 positionScale;
+        ci::ColorAf color;
+    };
+
+    std::vector<Instance> mInstances;
+    ci::gl::VboRef mInstanceVbo;
+    ci::gl::BatchRef mBatch;
+};
+
+inline size_t RingRenderer::getNumRings() const { return mInstances.size(); }
+
+template<typename FnT>
+void RingRenderer::forEach( FnT fn ) const
+{
+    for( const Instance &instance : mInstances )
+    {
+        fn( ci::vec3( instance.positionScale ), instance.positionScale.w, instance.color );
+    }
+}
@@ -1,115 +1,193 @@
 #include "SavitzkyGolayFilter.h"
+#include <array>
 #include <cassert>
-
-SavitzkyGolayFilter::SavitzkyGolayFilter( unsigned m, int t, unsigned n, unsigned s, float dt )
-    : mOptions( m, t, n, s, dt )
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+
+namespace
 {
-    init();
-}
 
-SavitzkyGolayFilter::SavitzkyGolayFilter( const Options &options )
-    : mOptions( options )
+constexpr int MaxOrder = static_cast<int>( SavitzkyGolayFilter::MaxOrder );
+
+// Gram polynomials p[ k ][ d ] = P_k^(d)( i ) for k <= n and d <= s, filled
+// in by the three-term recurrence instead of recursing per term.
+constexpr void gramPolys( const int i, const int m, const int n, const int s, double ( &p )[MaxOrder + 1][MaxOrder + 1] )
 {
-    init();
+    for( int d = 0; d <= s; ++d )
+    {
+        p[0][d] = d == 0 ? 1.0 : 0.0;
+        for( int k = 1; k <= n; ++k )
+        {
+            const double a = ( 4.0 * k - 2.0 ) / ( k * ( 2.0 * m - k + 1.0 ) );
+            const double b = ( ( k - 1.0 ) * ( 2.0 * m + k ) ) / ( k * ( 2.0 * m - k + 1.0 ) );
+            p[k][d] = a * ( i * p[k - 1][d] + ( d > 0 ? d * p[k - 1][d - 1] : 0.0 ) )
+                - ( k >= 2 ? b * p[k - 2][d] : 0.0 );
+        }
+    }
 }
 
-SavitzkyGolayFilter::SavitzkyGolayFilter()
+constexpr double genFact( const int a, const int b )
 {
-    init();
+    double gf = 1.0;
+    for( int j = ( a - b ) + 1; j <= a; j++ )
+    {
+        gf *= j;
+    }
+    return gf;
 }
 
-float SavitzkyGolayFilter::gramPoly( const int i, const int m, const int k, const int s )
+// Fills the 2*m+1 weights of the t'th least-square point of the s'th
+// derivative, in double precision. Shared by the compile-time tables and
+// the runtime cache.
+constexpr void computeWeightsInto( const int m, const int t, const int n, const int s, float *weights )
 {
-    if( k > 0 )
+    double pt[MaxOrder + 1][MaxOrder + 1] = {};
+    gramPolys( t, m, n, s, pt );
+    double factors[MaxOrder + 1] = {};
+    for( int k = 0; k <= n; ++k )
     {
-        return ( 4.0f * k - 2.0f ) / ( k * ( 2.0f * m - k + 1.0f ) ) * ( i * gramPoly( i, m, k - 1, s ) + s * gramPoly( i, m, k - 1, s - 1 ) )
-            - ( ( k - 1.0f ) * ( 2.0f * m + k ) ) / ( k * ( 2.0f * m - k + 1.0f ) ) * gramPoly( i, m, k - 2, s );
+        factors[k] = ( 2 * k + 1 ) * ( genFact( 2 * m, k ) / genFact( 2 * m + k + 1, k + 1 ) ) * pt[k][s];
     }
-    if( k == 0 && s == 0 )
+    for( int i = -m; i <= m; ++i )
     {
-        return 1.0f;
+        double pi[MaxOrder + 1][MaxOrder + 1] = {};
+        gramPolys( i, m, n, 0, pi );
+        double w = 0.0;
+        for( int k = 0; k <= n; ++k )
+        {
+            w += factors[k] * pi[k][0];
+        }
+        weights[i + m] = static_cast<float>( w );
     }
+}
 
-    return 0.0f;
+template<int M, int T, int N, int S>
+constexpr std::array<float, 2 * M + 1> makeWeights()
+{
+    static_assert( N <= MaxOrder && S <= N, "Unsupported Savitzky-Golay configuration" );
+    std::array<float, 2 * M + 1> weights{};
+    computeWeightsInto( M, T, N, S, weights.data() );
+    return weights;
 }
 
-float SavitzkyGolayFilter::genFact( const int a, const int b )
+template<int M, int T, int N, int S>
+constexpr std::array<float, 2 * M + 1> Precomputed = makeWeights<M, T, N, S>();
+
+struct PrecomputedWeights
 {
-    float gf = 1.0f;
+    int m;
+    int t;
+    int n;
+    int s;
+    const float *weights;
+};
+
+template<int M, int T, int N, int S>
+constexpr PrecomputedWeights precomputed()
+{
+    return { M, T, N, S, Precomputed<M, T, N, S>.data() };
+}
 
-    for( int j = ( a - b ) + 1; j <= a; j++ )
+// Real-time ( t = m ) configurations used for joint smoothing at 30 Hz.
+constexpr PrecomputedWeights PrecomputedTable[] = {
+    precomputed<3, 3, 2, 0>(), precomputed<3, 3, 2, 1>(), precomputed<3, 3, 2, 2>(),
+    precomputed<5, 5, 3, 0>(), precomputed<5, 5, 3, 1>(), precomputed<5, 5, 3, 2>(),
+    precomputed<8, 8, 3, 0>(), precomputed<8, 8, 3, 1>(), precomputed<8, 8, 3, 2>(),
+};
+
+// Smoothing weights reproduce a constant: they must sum to one.
+constexpr bool sumsToOne( const std::array<float, 11> &weights )
+{
+    double sum = 0.0;
+    for( float w : weights )
     {
-        gf *= j;
+        sum += w;
     }
+    return sum > 0.99999 && sum < 1.00001;
+}
+static_assert( sumsToOne( Precomputed<5, 5, 3, 0> ), "Savitzky-Golay weight recurrence is broken" );
 
-    return gf;
+} // namespace
+
+SavitzkyGolayFilter::SavitzkyGolayFilter( unsigned m, int t, unsigned n, unsigned s, float dt )
+    : mOptions( m, t, n, s, dt )
+{
+    init();
 }
 
-float SavitzkyGolayFilter::weight( const int i, const int t, const int m, const int n, const int s )
+SavitzkyGolayFilter::SavitzkyGolayFilter( const Options &options )
+    : mOptions( options )
 {
-    float w = 0.0f;
-    for( int k = 0; k <= n; ++k )
-    {
-        w = w
-            + ( 2 * k + 1 ) * ( genFact( 2 * m, k ) / genFact( 2 * m + k + 1, k + 1 ) ) * gramPoly( i, m, k, 0 )
-            * gramPoly( t, m, k, s );
-    }
+    init();
+}
 
-    return w;
+SavitzkyGolayFilter::SavitzkyGolayFilter()
+{
+    init();
 }
 
 std::vector<float> SavitzkyGolayFilter::computeWeights( const int m, const int t, const int n, const int s )
 {
+    assert( n <= static_cast<int>( MaxOrder ) && s <= static_cast<int>( MaxOrder ) );
     std::vector<float> weights( 2 * static_cast<size_t>( m ) + 1 );
-    for( int i = 0; i < 2 * m + 1; ++i )
-    {
-        weights[static_cast<size_t>( i )] = weight( i - m, t, m, n, s );
-    }
-
+    computeWeightsInto( m, t, n, s, weights.data() );
     return weights;
 }
 
-void SavitzkyGolayFilter::init()
+std::shared_ptr<const std::vector<float>> SavitzkyGolayFilter::findWeights( const int m, const int t, const int n, const int s )
 {
-    // Compute weights for the time window 2*m+1, for the t'th least-square
-    // point of the s'th derivative
-    mWeights = computeWeights( static_cast<int>( mOptions.m ),
-                               mOptions.t,
-                               static_cast<int>( mOptions.n ),
-                               static_cast<int>( mOptions.s ) );
-    mDt = static_cast<float>( std::pow( mOptions.timeStep(), mOptions.derivationOrder() ) );
-}
+    using Key = std::tuple<int, int, int, int>;
+    static std::mutex sMutex;
+    static std::map<Key, std::shared_ptr<const std::vector<float>>> sCache;
 
-ci::vec3 SavitzkyGolayFilter::filter( const std::vector<ci::vec3> &v, int offset ) const
-{
-    assert( v.size() >= mWeights.size() );// &&v.size() > 0 );
-    ci::vec3 res( mWeights[0] * v[v.size() - mWeights.size() - offset].x,
-                  mWeights[0] * v[v.size() - mWeights.size() - offset].y,
-                  mWeights[0] * v[v.size() - mWeights.size() - offset].z );
-    for( size_t i = 1; i < mWeights.size(); ++i )
+    std::lock_guard<std::mutex> lock( sMutex );
+    auto &weights = sCache[Key( m, t, n, s )];
+    if( !weights )
     {
-        res.x += mWeights[i] * v[v.size() - ( mWeights.size() - i ) - offset].x;
-        res.y += mWeights[i] * v[v.size() - ( mWeights.size() - i ) - offset].y;
-        res.z += mWeights[i] * v[v.size() - ( mWeights.size() - i ) - offset].z;
+        for( const PrecomputedWeights &entry : PrecomputedTable )
+        {
+            if( entry.m == m && entry.t == t && entry.n == n && entry.s == s )
+            {
+                weights = std::make_shared<const std::vector<float>>( entry.weights, entry.weights + 2 * m + 1 );
+                return weights;
+            }
+        }
+        weights = std::make_shared<const std::vector<float>>( computeWeights( m, t, n, s ) );
     }
-    res.x /= mDt;
-    res.y /= mDt;
-    res.z /= mDt;
+    return weights;
+}
 
-    return res;
+void SavitzkyGolayFilter::configure( const Options &options )
+{
+    // Checked first, so a rejected configuration leaves the filter as it was.
+    validate( options );
+    mOptions = options;
+    init();
 }
 
-float SavitzkyGolayFilter::filter( const std::vector<float> &v, int offset ) const
+void SavitzkyGolayFilter::validate( const Options &options )
 {
-    assert( v.size() >= mWeights.size() );// &&v.size() > 0 );
-    float res = ( mWeights[0] * v[v.size() - mWeights.size() - offset] );
-    for( size_t i = 1; i < mWeights.size(); ++i )
+    // The recurrence works in fixed MaxOrder + 1 square tables.
+    if( options.n > MaxOrder || options.s > MaxOrder )
     {
-        res += mWeights[i] * v[v.size() - ( mWeights.size() - i ) - offset];
+        throw std::invalid_argument( "Savitzky-Golay order and derivative must be at most " + std::to_string( MaxOrder ) );
     }
-    res /= mDt;
+}
 
-    return res;
+void SavitzkyGolayFilter::init()
+{
+    validate( mOptions );
+    // Compute weights for the time window 2*m+1, for the t'th least-square
+    // point of the s'th derivative
+    mWeights = findWeights( static_cast<int>( mOptions.m ),
+                            mOptions.t,
+                            static_cast<int>( mOptions.n ),
+                            static_cast<int>( mOptions.s ) );
+    mDt = static_cast<float>( std::pow( mOptions.timeStep(), mOptions.derivationOrder() ) );
 }
 
 std::ostream &operator<<( std::ostream &os, const SavitzkyGolayFilter::Options &options )
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cassert>
+#include <memory>
 #include <ostream>
 #include <vector>
 #include <cinder/Vector.h>
@@ -63,6 +65,8 @@ public:
         friend std::ostream &operator<<( std::ostream &os, const Options &conf );
     };
 
+    //! Throws std::invalid_argument if n or s is above MaxOrder, here and
+    //! in configure().
     SavitzkyGolayFilter( unsigned m, int t, unsigned n, unsigned s, float dt = 1.0f );
     SavitzkyGolayFilter( const Options &options );
     SavitzkyGolayFilter();
@@ -80,43 +84,46 @@ public:
     // and addition with itself
     // Common types would be std::vector<float>, std::vector<Eigen::VectorXd>, boost::circular_buffer<Eigen::Vector3d>...
     //
+    // @param offset Number of newest elements to skip.
+    //
     // @return Filtered value according to the precomputed filter weights.
     //
-    /*template<typename ContainerT>
-    typename ContainerT::value_type filter( const ContainerT &v ) const
+    template<typename ContainerT>
+    typename ContainerT::value_type filter( const ContainerT &v, int offset = 0 ) const
     {
-        assert( v.size() == weights_.size() && v.size() > 0 );
+        const std::vector<float> &weights = *mWeights;
+        assert( offset >= 0 && v.size() >= weights.size() + static_cast<size_t>( offset ) );
         using T = typename ContainerT::value_type;
-        T res = weights_[0] * v[0];
-        for( size_t i = 1; i < v.size(); ++i )
+        const size_t first = v.size() - weights.size() - static_cast<size_t>( offset );
+        T res = weights[0] * v[first];
+        for( size_t i = 1; i < weights.size(); ++i )
         {
-            res += weights_[i] * v[i];
+            res += weights[i] * v[first + i];
         }
-        return res / dt_;
-    }*/
-
-    // Todo: move to child Filter3d class.
-    ci::vec3 filter( const std::vector<ci::vec3> &v, int offset = 0 ) const;
-    float filter( const std::vector<float> &v, int offset = 0 ) const;
+        return res / mDt;
+    }
 
     const std::vector<float> &getWeights() const;
     void setWeights( const std::vector<float> &weights );
 
     const Options &getOptions() const;
 
+    //! Highest polynomial order the weight recurrence supports.
+    static constexpr unsigned MaxOrder = 16;
+
 private:
     void init();
-    static float gramPoly( const int i, const int m, const int k, const int s );
-    static float genFact( const int a, const int b );
-    static float weight( const int i, const int t, const int m, const int n, const int s );
+    static void validate( const Options &options );
+    //! Weights for ( m, t, n, s ), from the compile-time tables or a
+    //! process-wide cache; computed at most once per configuration.
+    static std::shared_ptr<const std::vector<float>> findWeights( const int m, const int t, const int n, const int s );
     static std::vector<float> computeWeights( const int m, const int t, const int n, const int s );
     Options mOptions;
-    std::vector<float> mWeights;
+    std::shared_ptr<const std::vector<float>> mWeights;
     float mDt{ 0.0f };
 
 };
 
-inline void SavitzkyGolayFilter::configure( const Options &options ) { mOptions = options; init(); }
-inline const std::vector<float> &SavitzkyGolayFilter::getWeights() const { return mWeights; }
-inline void SavitzkyGolayFilter::setWeights( const std::vector<float> &weights ) { mWeights = weights; }
+inline const std::vector<float> &SavitzkyGolayFilter::getWeights() const { return *mWeights; }
+inline void SavitzkyGolayFilter::setWeights( const std::vector<float> &weights ) { mWeights = std::make_shared<const std::vector<float>>( weights ); }
 inline const SavitzkyGolayFilter::Options &SavitzkyGolayFilter::getOptions() const { return mOptions; }
@@ -0,0 +1,407 @@
+#include "SavitzkyGolayFilterBank.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#if defined( __AVX__ )
+#include <immintrin.h>
+#elif defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+#include <emmintrin.h>
+#define SG_BANK_SSE2
+#endif
+
+namespace
+{
+
+// out[ o ][ c ] = sum over k of weights[ o ][ k ] * rows[ k ][ c ], for all
+// three outputs in one pass over the history. count is a multiple of 8 and
+// every pointer is 32-byte aligned.
+void convolve( const float *const *rows, size_t numRows, const float *const *weights, float *const *out, size_t count )
+{
+#if defined( __AVX__ )
+    for( size_t c = 0; c < count; c += 8 )
+    {
+        __m256 pos = _mm256_setzero_ps();
+        __m256 vel = _mm256_setzero_ps();
+        __m256 acc = _mm256_setzero_ps();
+        for( size_t k = 0; k < numRows; ++k )
+        {
+            const __m256 v = _mm256_load_ps( rows[ k ] + c );
+#if defined( __FMA__ )
+            pos = _mm256_fmadd_ps( _mm256_set1_ps( weights[ 0 ][ k ] ), v, pos );
+            vel = _mm256_fmadd_ps( _mm256_set1_ps( weights[ 1 ][ k ] ), v, vel );
+            acc = _mm256_fmadd_ps( _mm256_set1_ps( weights[ 2 ][ k ] ), v, acc );
+#else
+            pos = _mm256_add_ps( pos, _mm256_mul_ps( _mm256_set1_ps( weights[ 0 ][ k ] ), v ) );
+            vel = _mm256_add_ps( vel, _mm256_mul_ps( _mm256_set1_ps( weights[ 1 ][ k ] ), v ) );
+            acc = _mm256_add_ps( acc, _mm256_mul_ps( _mm256_set1_ps( weights[ 2 ][ k ] ), v ) );
+#endif
+        }
+        _mm256_store_ps( out[ 0 ] + c, pos );
+        _mm256_store_ps( out[ 1 ] + c, vel );
+        _mm256_store_ps( out[ 2 ] + c, acc );
+    }
+#elif defined( SG_BANK_SSE2 )
+    for( size_t c = 0; c < count; c += 4 )
+    {
+        __m128 pos = _mm_setzero_ps();
+        __m128 vel = _mm_setzero_ps();
+        __m128 acc = _mm_setzero_ps();
+        for( size_t k = 0; k < numRows; ++k )
+        {
+            const __m128 v = _mm_load_ps( rows[ k ] + c );
+            pos = _mm_add_ps( pos, _mm_mul_ps( _mm_set1_ps( weights[ 0 ][ k ] ), v ) );
+            vel = _mm_add_ps( vel, _mm_mul_ps( _mm_set1_ps( weights[ 1 ][ k ] ), v ) );
+            acc = _mm_add_ps( acc, _mm_mul_ps( _mm_set1_ps( weights[ 2 ][ k ] ), v ) );
+        }
+        _mm_store_ps( out[ 0 ] + c, pos );
+        _mm_store_ps( out[ 1 ] + c, vel );
+        _mm_store_ps( out[ 2 ] + c, acc );
+    }
+#else
+    for( size_t c = 0; c < count; ++c )
+    {
+        float pos = 0.0f;
+        float vel = 0.0f;
+        float acc = 0.0f;
+        for( size_t k = 0; k < numRows; ++k )
+        {
+            const float v = rows[ k ][ c ];
+            pos += weights[ 0 ][ k ] * v;
+            vel += weights[ 1 ][ k ] * v;
+            acc += weights[ 2 ][ k ] * v;
+        }
+        out[ 0 ][ c ] = pos;
+        out[ 1 ][ c ] = vel;
+        out[ 2 ][ c ] = acc;
+    }
+#endif
+}
+
+// Sensor ticks per second.
+constexpr double TicksPerSecond = 10000000.0;
+
+} // namespace
+
+SavitzkyGolayFilterBank::SavitzkyGolayFilterBank( const SavitzkyGolayFilter::Options &options )
+{
+    configure( options );
+}
+
+void SavitzkyGolayFilterBank::configure( const SavitzkyGolayFilter::Options &options )
+{
+    // History, taps and solver scratch are sized for MaxWindowSize rows.
+    // Checked before anything changes, so a rejected window keeps the old one.
+    if( options.window_size() > MaxWindowSize )
+    {
+        throw std::invalid_argument( "Savitzky-Golay filter bank window must be at most " + std::to_string( MaxWindowSize ) );
+    }
+    if( options.order() > SavitzkyGolayFilter::MaxOrder )
+    {
+        throw std::invalid_argument( "Savitzky-Golay order must be at most " + std::to_string( SavitzkyGolayFilter::MaxOrder ) );
+    }
+    mOptions = options;
+    for( size_t s = 0; s < OutputCount; ++s )
+    {
+        SavitzkyGolayFilter::Options derivative = options;
+        derivative.s = static_cast<unsigned>( s );
+        const SavitzkyGolayFilter filter( derivative );
+        const float scale = 1.0f / static_cast<float>( std::pow( derivative.timeStep(), derivative.derivationOrder() ) );
+        mWeights[ s ] = filter.getWeights();
+        for( float &weight : mWeights[ s ] )
+        {
+            weight *= scale;
+        }
+    }
+
+    mHistory.assign( options.window_size(), Row() );
+    for( Row &row : mHistory )
+    {
+        std::fill( std::begin( row.values ), std::end( row.values ), 0.0f );
+    }
+    for( Row &row : mOutputs )
+    {
+        std::fill( std::begin( row.values ), std::end( row.values ), 0.0f );
+    }
+    mHead = 0;
+    std::fill( std::begin( mResetPending ), std::end( mResetPending ), true );
+
+    // The history starts out uniform, one frame period apart.
+    const size_t window = mHistory.size();
+    mGaps.assign( window, 1 );
+    mNumIrregular = 0;
+    mSpan = static_cast<int>( window ) - 1;
+    mLastTimeStamp = -1;
+    std::fill( std::begin( mMoments ), std::end( mMoments ), 0.0 );
+    for( size_t k = 0; k < window; ++k )
+    {
+        double power = 1.0;
+        for( double &moment : mMoments )
+        {
+            moment += power;
+            power *= -static_cast<double>( k );
+        }
+    }
+    mPatternWeights.clear();
+    mPatternKey.assign( window > 0 ? window - 1 : 0, '\0' );
+    mNumIrregularPushes = 0;
+}
+
+void SavitzkyGolayFilterBank::setPosition( size_t body, size_t joint, const ci::vec3 &pos )
+{
+    assert( body < NumBodies && joint < NumJoints );
+    float *row = mHistory[ mHead ].values;
+    const size_t channel = body * NumJoints + joint;
+    row[ channel ] = pos.x;
+    row[ PlaneSize + channel ] = pos.y;
+    row[ 2 * PlaneSize + channel ] = pos.z;
+}
+
+void SavitzkyGolayFilterBank::resetBody( size_t body )
+{
+    assert( body < NumBodies );
+    mResetPending[ body ] = true;
+}
+
+void SavitzkyGolayFilterBank::push()
+{
+    if( mLastTimeStamp >= 0 )
+    {
+        mLastTimeStamp += std::llround( mOptions.timeStep() * TicksPerSecond );
+    }
+    advance( 1 );
+}
+
+void SavitzkyGolayFilterBank::push( long long timeStamp )
+{
+    int gap = 1;
+    const double period = mOptions.timeStep() * TicksPerSecond;
+    if( mLastTimeStamp >= 0 && period > 0.0 )
+    {
+        const long long periods = std::llround( static_cast<double>( timeStamp - mLastTimeStamp ) / period );
+        gap = static_cast<int>( std::min<long long>( std::max<long long>( periods, 1 ), MaxGap ) );
+    }
+    mLastTimeStamp = timeStamp;
+    advance( gap );
+}
+
+void SavitzkyGolayFilterBank::advance( int gap )
+{
+    const size_t window = mHistory.size();
+    const float *head = mHistory[ mHead ].values;
+    for( size_t body = 0; body < NumBodies; ++body )
+    {
+        if( !mResetPending[ body ] )
+        {
+            continue;
+        }
+        mResetPending[ body ] = false;
+        for( size_t plane = 0; plane < 3; ++plane )
+        {
+            const size_t begin = plane * PlaneSize + body * NumJoints;
+            for( Row &row : mHistory )
+            {
+                if( row.values != head )
+                {
+                    std::copy( head + begin, head + begin + NumJoints, row.values + begin );
+                }
+            }
+        }
+    }
+
+    // The row at mHead replaces the oldest one. The row after it becomes the
+    // oldest, and the gap before it no longer spans a sample in the window.
+    if( window > 1 )
+    {
+        const size_t oldest = ( mHead + 1 ) % window;
+        shiftMoments( gap );
+        mSpan += gap - mGaps[ oldest ];
+        mNumIrregular += ( gap != 1 ? 1 : 0 );
+        mNumIrregular -= ( mGaps[ oldest ] != 1 ? 1 : 0 );
+        mGaps[ mHead ] = static_cast<uint8_t>( gap );
+    }
+
+    const float *weights[ OutputCount ];
+    if( mNumIrregular == 0 )
+    {
+        for( size_t s = 0; s < OutputCount; ++s )
+        {
+            weights[ s ] = mWeights[ s ].data();
+        }
+    }
+    else
+    {
+        ++mNumIrregularPushes;
+        const WeightSet &pattern = findWeights();
+        for( size_t s = 0; s < OutputCount; ++s )
+        {
+            weights[ s ] = pattern.data() + s * window;
+        }
+    }
+
+    // configure() keeps the window within MaxWindowSize.
+    const float *rows[ MaxWindowSize ];
+    // Oldest first, ending with the row just assembled.
+    for( size_t k = 0; k < window; ++k )
+    {
+        rows[ k ] = mHistory[ ( mHead + 1 + k ) % window ].values;
+    }
+    float *out[ OutputCount ] = { mOutputs[ Position ].values, mOutputs[ Velocity ].values, mOutputs[ Acceleration ].values };
+    convolve( rows, window, weights, out, RowSize );
+
+    // The next frame starts from this one, so joints it does not set hold.
+    const size_t next = ( mHead + 1 ) % window;
+    mHistory[ next ] = mHistory[ mHead ];
+    mHead = next;
+}
+
+void SavitzkyGolayFilterBank::shiftMoments( int gap )
+{
+    // Moves every sample gap periods into the past, sum of ( x - gap )^p by
+    // the binomial expansion, then swaps the oldest sample for the new one at
+    // x = 0. O(n^2) per frame, however wide the window.
+    const size_t count = 2 * mOptions.order() + 1;
+    double shifted[ 2 * SavitzkyGolayFilter::MaxOrder + 1 ];
+    for( size_t p = 0; p < count; ++p )
+    {
+        double sum = 0.0;
+        double binomial = 1.0;
+        double power = 1.0;
+        // Sum over q = p down to 0 of C(p,q) (-gap)^(p-q) M_q.
+        for( size_t q = p + 1; q-- > 0; )
+        {
+            sum += binomial * power * mMoments[ q ];
+            binomial = binomial * static_cast<double>( q ) / static_cast<double>( p - q + 1 );
+            power *= -static_cast<double>( gap );
+        }
+        shifted[ p ] = sum;
+    }
+
+    const double dropped = -static_cast<double>( mSpan + gap );
+    double power = 1.0;
+    for( size_t p = 0; p < count; ++p )
+    {
+        mMoments[ p ] = shifted[ p ] - power;
+        power *= dropped;
+    }
+    mMoments[ 0 ] += 1.0;
+}
+
+const SavitzkyGolayFilterBank::WeightSet &SavitzkyGolayFilterBank::findWeights()
+{
+    const size_t window = mHistory.size();
+    for( size_t k = 1; k < window; ++k )
+    {
+        mPatternKey[ k - 1 ] = static_cast<char>( mGaps[ ( mHead + 1 + k ) % window ] );
+    }
+    auto it = mPatternWeights.find( mPatternKey );
+    if( it != mPatternWeights.end() )
+    {
+        return it->second;
+    }
+    if( mPatternWeights.size() >= MaxCachedPatterns )
+    {
+        mPatternWeights.clear();
+    }
+    WeightSet &weights = mPatternWeights[ mPatternKey ];
+    solveWeights( weights );
+    return weights;
+}
+
+void SavitzkyGolayFilterBank::solveWeights( WeightSet &weights ) const
+{
+    // Least squares fit of a degree n polynomial to samples at x_k, in frame
+    // periods with the newest at 0. The normal matrix G( a, b ) = sum x^(a+b)
+    // is the running moments, so only the (n+1)^2 system is solved here.
+    // Tap k of derivative s is sum over b of v( b ) x_k^b, where G v is the
+    // s-th derivative of the monomials at the evaluated sample.
+    const size_t window = mHistory.size();
+    const size_t size = mOptions.order() + 1;
+    constexpr size_t MaxSize = SavitzkyGolayFilter::MaxOrder + 1;
+
+    double offsets[ MaxWindowSize ];
+    offsets[ window - 1 ] = 0.0;
+    for( size_t k = window - 1; k > 0; --k )
+    {
+        offsets[ k - 1 ] = offsets[ k ] - mGaps[ ( mHead + 1 + k ) % window ];
+    }
+    const double at = offsets[ mOptions.dataPoint() + mOptions.m ];
+
+    // G augmented with one right-hand side per output, by Gauss-Jordan
+    // elimination with partial pivoting.
+    double system[ MaxSize ][ MaxSize + OutputCount ];
+    for( size_t a = 0; a < size; ++a )
+    {
+        for( size_t b = 0; b < size; ++b )
+        {
+            system[ a ][ b ] = mMoments[ a + b ];
+        }
+        for( size_t s = 0; s < OutputCount; ++s )
+        {
+            // d^s/dx^s x^a = a!/(a-s)! x^(a-s)
+            double value = a >= s ? 1.0 : 0.0;
+            for( size_t i = 0; i < s && a >= s; ++i )
+            {
+                value *= static_cast<double>( a - i );
+            }
+            for( size_t i = s; i < a; ++i )
+            {
+                value *= at;
+            }
+            system[ a ][ size + s ] = value;
+        }
+    }
+    for( size_t col = 0; col < size; ++col )
+    {
+        size_t pivot = col;
+        for( size_t row = col + 1; row < size; ++row )
+        {
+            if( std::abs( system[ row ][ col ] ) > std::abs( system[ pivot ][ col ] ) )
+            {
+                pivot = row;
+            }
+        }
+        std::swap( system[ col ], system[ pivot ] );
+        const double inverse = 1.0 / system[ col ][ col ];
+        for( size_t row = 0; row < size; ++row )
+        {
+            if( row == col )
+            {
+                continue;
+            }
+            const double factor = system[ row ][ col ] * inverse;
+            for( size_t i = col; i < size + OutputCount; ++i )
+            {
+                system[ row ][ i ] -= factor * system[ col ][ i ];
+            }
+        }
+    }
+
+    weights.assign( OutputCount * window, 0.0f );
+    for( size_t s = 0; s < OutputCount; ++s )
+    {
+        const double scale = 1.0 / std::pow( mOptions.timeStep(), static_cast<double>( s ) );
+        for( size_t k = 0; k < window; ++k )
+        {
+            double tap = 0.0;
+            double power = 1.0;
+            for( size_t b = 0; b < size; ++b )
+            {
+                tap += system[ b ][ size + s ] / system[ b ][ b ] * power;
+                power *= offsets[ k ];
+            }
+            weights[ s * window + k ] = static_cast<float>( tap * scale );
+        }
+    }
+}
+
+ci::vec3 SavitzkyGolayFilterBank::getOutput( Output output, size_t body, size_t joint ) const
+{
+    assert( body < NumBodies && joint < NumJoints );
+    const float *row = mOutputs[ output ].values;
+    const size_t channel = body * NumJoints + joint;
+    return ci::vec3( row[ channel ], row[ PlaneSize + channel ], row[ 2 * PlaneSize + channel ] );
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <cinder/Vector.h>
+#include <Kinect2Types.h>
+#include "SavitzkyGolayFilter.h"
+
+//! Streaming Savitzky-Golay smoothing of every joint of every body. The bank
+//! owns one ring buffer of the last 2*m+1 frames, stored as x, y and z planes
+//! of BODY_COUNT * JointType_Count floats, and each push() convolves all of
+//! it at once to produce position, velocity and acceleration. The kernels
+//! run 8 (AVX) or 4 (SSE) channels at a time.
+//!
+//! push( timeStamp ) fits the polynomial to the actual sample times instead
+//! of assuming a constant step. Gaps are measured in whole multiples of
+//! Options::dt, the nominal frame period, so a window only needs its own
+//! weights while a dropped frame is inside it, and each gap pattern is
+//! solved once and cached.
+class SavitzkyGolayFilterBank
+{
+public:
+    static constexpr size_t NumBodies = BODY_COUNT;
+    static constexpr size_t NumJoints = JointType_Count;
+    //! Floats per plane, padded to a whole number of AVX registers.
+    static constexpr size_t PlaneSize = ( NumBodies * NumJoints + 7 ) & ~size_t( 7 );
+    static constexpr size_t RowSize = 3 * PlaneSize;
+    static constexpr size_t MaxWindowSize = 64;
+    //! Longer gaps are treated as this many frame periods.
+    static constexpr int MaxGap = 8;
+    static constexpr size_t MaxCachedPatterns = 256;
+
+    //! \a options.s is ignored; derivatives 0, 1 and 2 are all computed.
+    //! Throws std::invalid_argument for a window above MaxWindowSize or an
+    //! order above SavitzkyGolayFilter::MaxOrder, here and in configure().
+    explicit SavitzkyGolayFilterBank( const SavitzkyGolayFilter::Options &options = SavitzkyGolayFilter::Options() );
+
+    void configure( const SavitzkyGolayFilter::Options &options );
+
+    //! Sets a joint sample for the frame being assembled. Joints not set
+    //! keep their previous value.
+    void setPosition( size_t body, size_t joint, const ci::vec3 &pos );
+    //! Starts \a body over: its next sample fills the whole window, so a new
+    //! person in a slot does not inherit the last one's motion.
+    void resetBody( size_t body );
+    //! Commits the assembled frame and filters every channel.
+    void push();
+    //! As push(), for a frame sampled at \a timeStamp (sensor ticks).
+    void push( long long timeStamp );
+
+    ci::vec3 getPosition( size_t body, size_t joint ) const;
+    ci::vec3 getVelocity( size_t body, size_t joint ) const;
+    ci::vec3 getAcceleration( size_t body, size_t joint ) const;
+
+    const SavitzkyGolayFilter::Options &getOptions() const;
+    size_t getWindowSize() const;
+    //! Non-uniform gap patterns solved so far.
+    size_t getNumCachedPatterns() const;
+    //! Pushes whose window contained a dropped frame.
+    uint64_t getNumIrregularPushes() const;
+
+private:
+    struct alignas( 32 ) Row
+    {
+        float values[ RowSize ];
+    };
+
+    enum Output
+    {
+        Position,
+        Velocity,
+        Acceleration,
+        OutputCount
+    };
+
+    //! Taps for one window, position then velocity then acceleration.
+    typedef std::vector<float> WeightSet;
+
+    ci::vec3 getOutput( Output output, size_t body, size_t joint ) const;
+    void advance( int gap );
+    void shiftMoments( int gap );
+    const WeightSet &findWeights();
+    void solveWeights( WeightSet &weights ) const;
+
+    SavitzkyGolayFilter::Options mOptions;
+    //! Weights per output, oldest tap first, already divided by dt^s.
+    std::vector<float> mWeights[ OutputCount ];
+    std::vector<Row> mHistory;
+    //! Ring index of the row being assembled.
+    size_t mHead{ 0 };
+    Row mOutputs[ OutputCount ];
+    bool mResetPending[ NumBodies ];
+
+    //! Frame periods between each row and the one before it.
+    std::vector<uint8_t> mGaps;
+    //! Gaps other than 1 among the rows after the oldest.
+    size_t mNumIrregular{ 0 };
+    //! Frame periods from the oldest row to the newest.
+    int mSpan{ 0 };
+    long long mLastTimeStamp{ -1 };
+    //! Sums of x^p over the window, x in frame periods with the newest at 0.
+    double mMoments[ 2 * SavitzkyGolayFilter::MaxOrder + 1 ];
+    std::unordered_map<std::string, WeightSet> mPatternWeights;
+    std::string mPatternKey;
+    uint64_t mNumIrregularPushes{ 0 };
+};
+
+inline const SavitzkyGolayFilter::Options &SavitzkyGolayFilterBank::getOptions() const { return mOptions; }
+inline size_t SavitzkyGolayFilterBank::getWindowSize() const { return mHistory.size(); }
+inline size_t SavitzkyGolayFilterBank::getNumCachedPatterns() const { return mPatternWeights.size(); }
+inline uint64_t SavitzkyGolayFilterBank::getNumIrregularPushes() const { return mNumIrregularPushes; }
+inline ci::vec3 SavitzkyGolayFilterBank::getPosition( size_t body, size_t joint ) const { return getOutput( Position, body, joint ); }
+inline ci::vec3 SavitzkyGolayFilterBank::getVelocity( size_t body, size_t joint ) const { return getOutput( Velocity, body, joint ); }
+inline ci::vec3 SavitzkyGolayFilterBank::getAcceleration( size_t body, size_t joint ) const { return getOutput( Acceleration, body, joint ); }
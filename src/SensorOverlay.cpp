@@ -0,0 +1,144 @@
+#include "SensorOverlay.h"
+#include <algorithm>
+#include <Kinect2Frame.h>
+#include <cinder/gl/draw.h>
+#include <cinder/gl/scoped.h>
+
+namespace
+{
+
+const char *OverlayVertexShader = R"(
+#version 150
+uniform mat4 ciModelViewProjection;
+in vec4 ciPosition;
+in vec2 ciTexCoord0;
+in vec4 ciColor;
+out vec2 vTexCoord0;
+out vec4 vColor;
+void main()
+{
+    vTexCoord0 = ciTexCoord0;
+    vColor = ciColor;
+    gl_Position = ciModelViewProjection * ciPosition;
+}
+)";
+
+const char *DepthFragmentShader = R"(
+#version 150
+uniform usampler2D uTex0;
+uniform float uNear;
+uniform float uFar;
+in vec2 vTexCoord0;
+in vec4 vColor;
+out vec4 oColor;
+void main()
+{
+    float depth = float( texture( uTex0, vTexCoord0 ).r );
+    float grey = clamp( ( depth - uNear ) / ( uFar - uNear ), 0.0, 1.0 );
+    oColor = vec4( vec3( grey ), 1.0 ) * vColor;
+}
+)";
+
+// Body index 0 to BODY_COUNT look up the palette; anything else (255 is
+// "no body") is transparent.
+const char *BodyIndexFragmentShader = R"(
+#version 150
+uniform usampler2D uTex0;
+uniform vec4 uPalette[ 7 ];
+in vec2 vTexCoord0;
+in vec4 vColor;
+out vec4 oColor;
+void main()
+{
+    uint index = texture( uTex0, vTexCoord0 ).r;
+    oColor = index < 7u ? uPalette[ index ] * vColor : vec4( 0.0 );
+}
+)";
+
+constexpr int PaletteSize = BODY_COUNT + 1;
+static_assert( PaletteSize == 7, "Update uPalette in BodyIndexFragmentShader" );
+
+} // namespace
+
+SensorOverlayRef SensorOverlay::create()
+{
+    return SensorOverlayRef( new SensorOverlay() );
+}
+
+SensorOverlay::SensorOverlay()
+{
+    mDepthGlsl = ci::gl::GlslProg::create( ci::gl::GlslProg::Format().vertex( OverlayVertexShader ).fragment( DepthFragmentShader ) );
+    mDepthGlsl->uniform( "uTex0", 0 );
+    setDepthWindow( mDepthNear, mDepthFar );
+
+    // Same colours and transparency as Kinect2::colorizeBodyIndex().
+    ci::vec4 palette[ PaletteSize ];
+    for( int index = 0; index < PaletteSize; ++index )
+    {
+        const ci::Colorf color( Kinect2::getBodyColor( index ) );
+        palette[ index ] = ci::vec4( color.r, color.g, color.b, index == 0 ? 0.0f : 1.0f );
+    }
+    mBodyIndexGlsl = ci::gl::GlslProg::create( ci::gl::GlslProg::Format().vertex( OverlayVertexShader ).fragment( BodyIndexFragmentShader ) );
+    mBodyIndexGlsl->uniform( "uTex0", 0 );
+    mBodyIndexGlsl->uniform( "uPalette", palette, PaletteSize );
+}
+
+void SensorOverlay::setDepth( const ci::Channel16uRef &channel )
+{
+    mDepth = channel;
+    mHasNewDepth = static_cast<bool>( channel );
+}
+
+void SensorOverlay::setBodyIndex( const ci::Channel8uRef &channel )
+{
+    mBodyIndex = channel;
+    mHasNewBodyIndex = static_cast<bool>( channel );
+}
+
+void SensorOverlay::drawDepth( const ci::Rectf &bounds )
+{
+    if( mHasNewDepth )
+    {
+        if( !mDepthTexture || mDepthTexture->getSize() != mDepth->getSize() )
+        {
+            mDepthTexture = StreamedTexture::create( mDepth->getSize(), StreamedTexture::Format::Uint16 );
+        }
+        mDepthTexture->update( mDepth->getData(), mDepth->getRowBytes() );
+        mHasNewDepth = false;
+    }
+    draw( mDepthTexture, mDepthGlsl, bounds );
+}
+
+void SensorOverlay::drawBodyIndex( const ci::Rectf &bounds )
+{
+    if( mHasNewBodyIndex )
+    {
+        if( !mBodyIndexTexture || mBodyIndexTexture->getSize() != mBodyIndex->getSize() )
+        {
+            mBodyIndexTexture = StreamedTexture::create( mBodyIndex->getSize(), StreamedTexture::Format::Uint8 );
+        }
+        mBodyIndexTexture->update( mBodyIndex->getData(), mBodyIndex->getRowBytes() );
+        mHasNewBodyIndex = false;
+    }
+    draw( mBodyIndexTexture, mBodyIndexGlsl, bounds );
+}
+
+void SensorOverlay::setDepthWindow( float nearDepth, float farDepth )
+{
+    mDepthNear = nearDepth;
+    mDepthFar = std::max( farDepth, nearDepth + 1.0f );
+    mDepthGlsl->uniform( "uNear", mDepthNear );
+    mDepthGlsl->uniform( "uFar", mDepthFar );
+}
+
+void SensorOverlay::draw( const StreamedTextureRef &texture, const ci::gl::GlslProgRef &glsl, const ci::Rectf &bounds )
+{
+    if( !texture )
+    {
+        return;
+    }
+    ci::gl::ScopedTextureBind textureBind( texture->getTexture(), 0 );
+    ci::gl::ScopedGlslProg glslBind( glsl );
+    // Rows are stored top first.
+    ci::gl::drawSolidRect( bounds, ci::vec2( 0.0f, 0.0f ), ci::vec2( 1.0f, 1.0f ) );
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <memory>
+#include <cinder/Channel.h>
+#include <cinder/Rect.h>
+#include <cinder/gl/GlslProg.h>
+#include "StreamedTexture.h"
+
+typedef std::shared_ptr<class SensorOverlay> SensorOverlayRef;
+
+//! Draws the depth and body-index images straight from the sensor's raw
+//! channels. Both are uploaded untouched as unsigned integer textures; the
+//! depth window and the body palette are applied in fragment shaders, so
+//! the CPU only copies each new frame into a pixel buffer.
+class SensorOverlay
+{
+public:
+    //! Needs a current GL context.
+    static SensorOverlayRef create();
+
+    //! Hands over a new frame, uploaded on the next draw.
+    void setDepth( const ci::Channel16uRef &channel );
+    void setBodyIndex( const ci::Channel8uRef &channel );
+
+    //! Draw with the current colour, which multiplies the image.
+    void drawDepth( const ci::Rectf &bounds );
+    void drawBodyIndex( const ci::Rectf &bounds );
+
+    //! Depth in millimetres shown from black to white.
+    void setDepthWindow( float nearDepth, float farDepth );
+    float getDepthNear() const;
+    float getDepthFar() const;
+
+private:
+    SensorOverlay();
+
+    void draw( const StreamedTextureRef &texture, const ci::gl::GlslProgRef &glsl, const ci::Rectf &bounds );
+
+    ci::gl::GlslProgRef mDepthGlsl;
+    ci::gl::GlslProgRef mBodyIndexGlsl;
+    StreamedTextureRef mDepthTexture;
+    StreamedTextureRef mBodyIndexTexture;
+    ci::Channel16uRef mDepth;
+    ci::Channel8uRef mBodyIndex;
+    bool mHasNewDepth{ false };
+    bool mHasNewBodyIndex{ false };
+    // Matches the old 16 to 8 bit shift: 0 to 4095 mm.
+    float mDepthNear{ 0.0f };
+    float mDepthFar{ 4096.0f };
+};
+
+inline float SensorOverlay::getDepthNear() const { return mDepthNear; }
+inline float SensorOverlay::getDepthFar() const { return mDepthFar; }
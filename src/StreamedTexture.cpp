@@ -0,0 +1,91 @@
+#include "StreamedTexture.h"
+#include <algorithm>
+#include <cstring>
+
+StreamedTextureRef StreamedTexture::create( const ci::ivec2 &size, Format format )
+{
+    return StreamedTextureRef( new StreamedTexture( size, format ) );
+}
+
+StreamedTexture::StreamedTexture( const ci::ivec2 &size, Format format )
+    : mSize( size )
+    , mFormat( format )
+{
+    ci::gl::Texture2d::Format textureFormat;
+    textureFormat.loadTopDown();
+    switch( format )
+    {
+    case Format::Grey8:
+        mDataFormat = GL_RED;
+        mDataType = GL_UNSIGNED_BYTE;
+        textureFormat.internalFormat( GL_R8 ).swizzleMask( GL_RED, GL_RED, GL_RED, GL_ONE );
+        break;
+    case Format::Rgba8:
+        mBytesPerPixel = 4;
+        mDataFormat = GL_RGBA;
+        mDataType = GL_UNSIGNED_BYTE;
+        textureFormat.internalFormat( GL_RGBA8 );
+        break;
+    case Format::Uint8:
+        mDataFormat = GL_RED_INTEGER;
+        mDataType = GL_UNSIGNED_BYTE;
+        // Integer textures cannot be filtered.
+        textureFormat.internalFormat( GL_R8UI ).minFilter( GL_NEAREST ).magFilter( GL_NEAREST );
+        break;
+    case Format::Uint16:
+        mBytesPerPixel = 2;
+        mDataFormat = GL_RED_INTEGER;
+        mDataType = GL_UNSIGNED_SHORT;
+        textureFormat.internalFormat( GL_R16UI ).minFilter( GL_NEAREST ).magFilter( GL_NEAREST );
+        break;
+    }
+    mTexture = ci::gl::Texture2d::create( size.x, size.y, textureFormat );
+
+    const size_t bytes = getRowBytes() * static_cast<size_t>( size.y );
+    for( ci::gl::PboRef &buffer : mBuffers )
+    {
+        buffer = ci::gl::Pbo::create( GL_PIXEL_UNPACK_BUFFER, bytes, nullptr, GL_STREAM_DRAW );
+    }
+}
+
+uint8_t *StreamedTexture::map()
+{
+    mBufferIndex = ( mBufferIndex + 1 ) % NumBuffers;
+    // Invalidating the whole range lets the driver hand out fresh memory
+    // instead of waiting for the last upload from this buffer.
+    return static_cast<uint8_t *>( mBuffers[ mBufferIndex ]->mapReplace() );
+}
+
+void StreamedTexture::upload()
+{
+    const ci::gl::PboRef &buffer = mBuffers[ mBufferIndex ];
+    buffer->unmap();
+    // Rows are tightly packed; narrow rows need not be 4-aligned.
+    GLint alignment = 4;
+    glGetIntegerv( GL_UNPACK_ALIGNMENT, &alignment );
+    glPixelStorei( GL_UNPACK_ALIGNMENT, 1 );
+    mTexture->update( buffer, mDataFormat, mDataType );
+    glPixelStorei( GL_UNPACK_ALIGNMENT, alignment );
+}
+
+void StreamedTexture::update( const void *data, size_t rowBytes )
+{
+    uint8_t *dst = map();
+    if( dst )
+    {
+        const size_t dstRowBytes = getRowBytes();
+        const uint8_t *src = static_cast<const uint8_t *>( data );
+        if( rowBytes == dstRowBytes )
+        {
+            std::memcpy( dst, src, dstRowBytes * static_cast<size_t>( mSize.y ) );
+        }
+        else
+        {
+            for( int y = 0; y < mSize.y; ++y )
+            {
+                std::memcpy( dst + y * dstRowBytes, src + y * rowBytes, std::min( rowBytes, dstRowBytes ) );
+            }
+        }
+    }
+    upload();
+}
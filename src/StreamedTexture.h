@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <cinder/Vector.h>
+#include <cinder/gl/Pbo.h>
+#include <cinder/gl/Texture.h>
+
+typedef std::shared_ptr<class StreamedTexture> StreamedTextureRef;
+
+//! A texture allocated once and refilled in place from a pair of pixel
+//! buffer objects. Each update is written straight into one mapped buffer
+//! and copied to the texture from there, while the GPU may still be
+//! reading the other, so neither the CPU nor the driver waits on a
+//! transfer in flight.
+class StreamedTexture
+{
+public:
+    enum class Format
+    {
+        //! 8 bits, shown as grey.
+        Grey8,
+        Rgba8,
+        //! Unsigned integer textures, read with a usampler2D.
+        Uint8,
+        Uint16
+    };
+
+    static StreamedTextureRef create( const ci::ivec2 &size, Format format );
+
+    //! Memory for the next image, rows getRowBytes() apart. Valid until
+    //! upload(), which must follow.
+    uint8_t *map();
+    //! Copies the mapped image into the texture.
+    void upload();
+    //! Copies an image whose rows are \a rowBytes apart and uploads it.
+    void update( const void *data, size_t rowBytes );
+
+    const ci::gl::Texture2dRef &getTexture() const;
+    const ci::ivec2 &getSize() const;
+    Format getFormat() const;
+    size_t getRowBytes() const;
+
+private:
+    StreamedTexture( const ci::ivec2 &size, Format format );
+
+    static constexpr size_t NumBuffers = 2;
+
+    ci::ivec2 mSize;
+    Format mFormat;
+    size_t mBytesPerPixel{ 1 };
+    GLenum mDataFormat{ 0 };
+    GLenum mDataType{ 0 };
+    ci::gl::Texture2dRef mTexture;
+    ci::gl::PboRef mBuffers[ NumBuffers ];
+    size_t mBufferIndex{ 0 };
+};
+
+inline const ci::gl::Texture2dRef &StreamedTexture::getTexture() const { return mTexture; }
+inline const ci::ivec2 &StreamedTexture::getSize() const { return mSize; }
+inline StreamedTexture::Format StreamedTexture::getFormat() const { return mFormat; }
+inline size_t StreamedTexture::getRowBytes() const { return static_cast<size_t>( mSize.x ) * mBytesPerPixel; }
@@ -0,0 +1,224 @@
+// Runs recorded sessions through the dance detector without a window, as
+// fast as the recordings can be decoded. Recordings are analyzed in
+// parallel; events are printed as CSV in command line order. Beats come
+// from the same virtual Link timeline the app's --simulate mode uses, so
+// results are repeatable and match a simulated replay: the session
+// timeline recorded next to a recording (<recording>.link) when there is
+// one, otherwise a fixed --bpm tempo.
+//
+//   house-dancer-analyzer [--bpm <tempo>] [--threads <n>] [--verbose] <recording>...
+//   house-dancer-analyzer --bench-filter [<frames>]
+//   house-dancer-analyzer --bench-host-time-filter [<updates>]
+//   house-dancer-analyzer --rate-sweep
+//   house-dancer-analyzer --test-scheduler
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <string>
+#include <vector>
+#include <cinder/Filesystem.h>
+#include <cinder/Log.h>
+#include <Kinect2Recording.h>
+#include <LinkTimeline.h>
+#include <LinkWrapper.h>
+#include "DanceDetector.h"
+#include "FilterBenchmark.h"
+#include "HostTimeFilterBenchmark.h"
+#include "RateSweep.h"
+#include "SchedulerTest.h"
+#include "ThreadPool.h"
+
+// Sensor time stamps are in 100 ns ticks.
+static constexpr double TicksPerSecond = 10000000.0;
+
+struct Analysis
+{
+    std::string path;
+    std::vector<DanceEvent> events;
+    long long startTimeStamp{ 0 };
+    long long endTimeStamp{ 0 };
+    //! Anchors the timeline, as the app's first simulated body frame does.
+    long long firstBodyTimeStamp{ 0 };
+    LinkTimelinePlayerRef timeline;
+    size_t numBodyFrames{ 0 };
+    std::string error;
+};
+
+static void analyze( Analysis &analysis )
+{
+    try
+    {
+        Kinect2::RecordingReaderRef reader = Kinect2::RecordingReader::create( analysis.path );
+        if( ci::fs::exists( analysis.path + ".link" ) )
+        {
+            analysis.timeline = LinkTimelinePlayer::create( analysis.path + ".link" );
+        }
+        analysis.startTimeStamp = reader->getStartTimeStamp();
+
+        DanceDetector detector;
+        while( reader->next() )
+        {
+            if( reader->getRecordType() == Kinect2::RecordType_Body )
+            {
+                const Kinect2::BodyFrame &frame = reader->getBodyFrame();
+                if( analysis.numBodyFrames == 0 )
+                {
+                    analysis.firstBodyTimeStamp = frame.getTimeStamp();
+                }
+                detector.process( frame, analysis.events );
+                ++analysis.numBodyFrames;
+            }
+            analysis.endTimeStamp = reader->getTimeStamp();
+        }
+    }
+    catch( const std::exception &exc )
+    {
+        analysis.error = exc.what();
+    }
+}
+
+// The timeline in force at a sensor time stamp. Sensor and simulated host
+// time coincide, so a recorded state starts at its own sensor time.
+static LinkWrapper::Snapshot timelineAt( const Analysis &analysis, const LinkWrapper::Snapshot &fixed, long long timeStamp )
+{
+    const LinkTimelineRecord *record = analysis.timeline ? analysis.timeline->getRecordAt( timeStamp ) : nullptr;
+    if( !record )
+    {
+        return fixed;
+    }
+    LinkWrapper::Snapshot timeline;
+    timeline.hostTime = std::chrono::microseconds( record->sensorTime / 10 );
+    timeline.tempo = record->tempo;
+    timeline.beat = record->beat;
+    timeline.quantum = record->quantum;
+    timeline.isPlaying = record->isPlaying != 0;
+    return timeline;
+}
+
+static void printUsage()
+{
+    std::fprintf( stderr, "usage: house-dancer-analyzer [--bpm <tempo>] [--threads <n>] [--verbose] <recording>...\n" );
+    std::fprintf( stderr, "       house-dancer-analyzer --bench-filter [<frames>]\n" );
+    std::fprintf( stderr, "       house-dancer-analyzer --bench-host-time-filter [<updates>]\n" );
+    std::fprintf( stderr, "       house-dancer-analyzer --rate-sweep\n" );
+    std::fprintf( stderr, "       house-dancer-analyzer --test-scheduler\n" );
+}
+
+int main( int argc, char *argv[] )
+{
+    if( argc >= 2 && std::string( argv[ 1 ] ) == "--bench-filter" )
+    {
+        return runFilterBenchmark( argc >= 3 ? static_cast<size_t>( std::atol( argv[ 2 ] ) ) : 10000 );
+    }
+    if( argc >= 2 && std::string( argv[ 1 ] ) == "--bench-host-time-filter" )
+    {
+        return runHostTimeFilterBenchmark( argc >= 3 ? static_cast<size_t>( std::atol( argv[ 2 ] ) ) : 200000 );
+    }
+    if( argc >= 2 && std::string( argv[ 1 ] ) == "--rate-sweep" )
+    {
+        ci::log::manager()->disableConsoleLogging();
+        return runRateSweep();
+    }
+    if( argc >= 2 && std::string( argv[ 1 ] ) == "--test-scheduler" )
+    {
+        return runSchedulerTest();
+    }
+
+    double bpm = 120.0;
+    size_t numThreads = std::thread::hardware_concurrency();
+    bool verbose = false;
+    std::vector<Analysis> analyses;
+    for( int i = 1; i < argc; ++i )
+    {
+        const std::string arg = argv[ i ];
+        if( arg == "--bpm" && i + 1 < argc )
+        {
+            bpm = std::atof( argv[ ++i ] );
+        }
+        else if( arg == "--threads" && i + 1 < argc )
+        {
+            numThreads = static_cast<size_t>( std::atoi( argv[ ++i ] ) );
+        }
+        else if( arg == "--verbose" )
+        {
+            verbose = true;
+        }
+        else if( arg.rfind( "--", 0 ) == 0 )
+        {
+            printUsage();
+            return EXIT_FAILURE;
+        }
+        else
+        {
+            analyses.emplace_back();
+            analyses.back().path = arg;
+        }
+    }
+    if( analyses.empty() || bpm <= 0.0 )
+    {
+        printUsage();
+        return EXIT_FAILURE;
+    }
+    if( !verbose )
+    {
+        // The detector logs every state change; far too much for batch runs.
+        ci::log::manager()->disableConsoleLogging();
+    }
+
+    const auto startTime = std::chrono::steady_clock::now();
+    size_t numSteals = 0;
+    size_t numWorkers = 0;
+    {
+        ThreadPool pool( numThreads );
+        for( Analysis &analysis : analyses )
+        {
+            pool.submit( [&analysis] { analyze( analysis ); } );
+        }
+        pool.wait();
+        numSteals = pool.getNumSteals();
+        numWorkers = pool.getNumThreads();
+    }
+    const double elapsed = std::chrono::duration<double>( std::chrono::steady_clock::now() - startTime ).count();
+
+    // Beats follow the recorded session timeline, or else count from the
+    // first body frame at a fixed tempo, where
+    // HouseDancerApp::advanceSimulatedTime starts its timeline.
+    int result = EXIT_SUCCESS;
+    size_t numBodyFrames = 0;
+    double recordedSeconds = 0.0;
+    std::printf( "recording,type,body,seconds,beat,phase,x,y,z\n" );
+    for( const Analysis &analysis : analyses )
+    {
+        if( !analysis.error.empty() )
+        {
+            std::fprintf( stderr, "%s: %s\n", analysis.path.c_str(), analysis.error.c_str() );
+            result = EXIT_FAILURE;
+            continue;
+        }
+        numBodyFrames += analysis.numBodyFrames;
+        recordedSeconds += ( analysis.endTimeStamp - analysis.startTimeStamp ) / TicksPerSecond;
+        LinkWrapper::Snapshot fixed;
+        fixed.hostTime = std::chrono::microseconds( analysis.firstBodyTimeStamp / 10 );
+        fixed.tempo = bpm;
+        fixed.isPlaying = true;
+        for( const DanceEvent &event : analysis.events )
+        {
+            const double seconds = ( event.timeStamp - analysis.startTimeStamp ) / TicksPerSecond;
+            const LinkWrapper::Snapshot timeline = timelineAt( analysis, fixed, event.timeStamp );
+            const double beat = timeline.beatAtTime( std::chrono::microseconds( event.timeStamp / 10 ) );
+            std::printf( "%s,%s,%llu,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f\n",
+                analysis.path.c_str(),
+                event.type == DanceEvent::Type::FootStep ? "step" : "knee",
+                static_cast<unsigned long long>( event.bodyId ),
+                seconds, beat, beat - std::floor( beat ),
+                event.pos.x, event.pos.y, event.pos.z );
+        }
+    }
+    std::fprintf( stderr, "%zu recordings, %zu body frames in %.3f s (%.0f frames/s, %.0fx real time, %zu threads, %zu steals)\n",
+        analyses.size(), numBodyFrames, elapsed, elapsed > 0.0 ? numBodyFrames / elapsed : 0.0,
+        elapsed > 0.0 ? recordedSeconds / elapsed : 0.0, numWorkers, numSteals );
+    return result;
+}
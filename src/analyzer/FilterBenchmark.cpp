@@ -0,0 +1,238 @@
+#include "FilterBenchmark.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "SavitzkyGolayFilterBank.h"
+
+namespace
+{
+
+constexpr size_t NumBodies = SavitzkyGolayFilterBank::NumBodies;
+constexpr size_t NumJoints = SavitzkyGolayFilterBank::NumJoints;
+constexpr size_t NumSignals = NumBodies * NumJoints;
+
+ci::vec3 samplePosition( size_t signal, size_t frame )
+{
+    const float t = static_cast<float>( frame ) / 30.0f + static_cast<float>( signal ) * 0.1f;
+    return ci::vec3( std::sin( t ), std::cos( t * 1.3f ), 2.0f + 0.1f * std::sin( t * 0.7f ) );
+}
+
+// Runs the bank over the samples, stamping frame i at the i-th entry of
+// timeStamps, or with push() when there are none. Returns seconds.
+double runBank( SavitzkyGolayFilterBank &bank, const std::vector<ci::vec3> &samples, const std::vector<long long> &timeStamps, size_t numFrames )
+{
+    const auto start = std::chrono::steady_clock::now();
+    for( size_t frame = 0; frame < numFrames; ++frame )
+    {
+        for( size_t body = 0; body < NumBodies; ++body )
+        {
+            for( size_t joint = 0; joint < NumJoints; ++joint )
+            {
+                bank.setPosition( body, joint, samples[ frame * NumSignals + body * NumJoints + joint ] );
+            }
+        }
+        if( timeStamps.empty() )
+        {
+            bank.push();
+        }
+        else
+        {
+            bank.push( timeStamps[ frame ] );
+        }
+    }
+    return std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+}
+
+float maxDifference( const ci::vec3 &a, const ci::vec3 &b )
+{
+    return std::max( { std::abs( a.x - b.x ), std::abs( a.y - b.y ), std::abs( a.z - b.z ) } );
+}
+
+// A cubic per signal, in seconds from the signal's own check frame so it
+// stays small where it is checked. Order 3 fits reproduce it exactly,
+// dropped frames or not.
+struct Cubic
+{
+    double c[ 4 ];
+
+    double at( double u, unsigned derivative ) const
+    {
+        switch( derivative )
+        {
+            case 0: return c[ 0 ] + u * ( c[ 1 ] + u * ( c[ 2 ] + u * c[ 3 ] ) );
+            case 1: return c[ 1 ] + u * ( 2.0 * c[ 2 ] + u * 3.0 * c[ 3 ] );
+            default: return 2.0 * c[ 2 ] + u * 6.0 * c[ 3 ];
+        }
+    }
+};
+
+Cubic makeCubic( size_t signal, size_t axis )
+{
+    const double k = static_cast<double>( signal * 3 + axis );
+    return { { std::sin( k ), 0.5 * std::cos( k * 1.7 ), 0.3 * std::sin( k * 0.3 ), 0.2 * std::cos( k * 2.3 ) } };
+}
+
+// Runs an order 3 bank over time stamps with jitter and dropped frames and
+// checks each signal against its cubic at its own frame, spread over the
+// run, so windows with and without gaps are both checked after the moments
+// have been shifted for many frames. \a periods is each frame's time in
+// whole frame periods. Returns the largest error of any output.
+float checkDroppedFrames( const SavitzkyGolayFilter::Options &options, const std::vector<long long> &timeStamps, const std::vector<long long> &periods )
+{
+    const size_t numFrames = timeStamps.size();
+    const size_t window = options.window_size();
+    std::vector<size_t> checkFrames( NumSignals );
+    for( size_t signal = 0; signal < NumSignals; ++signal )
+    {
+        checkFrames[ signal ] = window + signal * ( numFrames - window ) / NumSignals;
+    }
+
+    SavitzkyGolayFilterBank bank( options );
+    float error = 0.0f;
+    for( size_t frame = 0; frame < numFrames; ++frame )
+    {
+        for( size_t signal = 0; signal < NumSignals; ++signal )
+        {
+            const double u = static_cast<double>( periods[ frame ] - periods[ checkFrames[ signal ] ] ) * options.timeStep();
+            ci::vec3 position;
+            for( size_t axis = 0; axis < 3; ++axis )
+            {
+                position[ static_cast<int>( axis ) ] = static_cast<float>( makeCubic( signal, axis ).at( u, 0 ) );
+            }
+            bank.setPosition( signal / NumJoints, signal % NumJoints, position );
+        }
+        bank.push( timeStamps[ frame ] );
+
+        for( size_t signal = 0; signal < NumSignals; ++signal )
+        {
+            if( checkFrames[ signal ] != frame )
+            {
+                continue;
+            }
+            const size_t body = signal / NumJoints;
+            const size_t joint = signal % NumJoints;
+            const ci::vec3 outputs[ 3 ] = { bank.getPosition( body, joint ), bank.getVelocity( body, joint ), bank.getAcceleration( body, joint ) };
+            for( unsigned derivative = 0; derivative < 3; ++derivative )
+            {
+                ci::vec3 expected;
+                for( size_t axis = 0; axis < 3; ++axis )
+                {
+                    expected[ static_cast<int>( axis ) ] = static_cast<float>( makeCubic( signal, axis ).at( 0.0, derivative ) );
+                }
+                error = std::max( error, maxDifference( outputs[ derivative ], expected ) );
+            }
+        }
+    }
+    return error;
+}
+
+} // namespace
+
+int runFilterBenchmark( size_t numFrames )
+{
+    // 30 Hz real-time configuration.
+    const SavitzkyGolayFilter::Options options( 5, 5, 3, 0, 1.0f / 30.0f );
+    const size_t window = options.window_size();
+    numFrames = std::max( numFrames, window );
+
+    // Generated up front so only the filtering is timed.
+    std::vector<ci::vec3> samples( numFrames * NumSignals );
+    for( size_t frame = 0; frame < numFrames; ++frame )
+    {
+        for( size_t signal = 0; signal < NumSignals; ++signal )
+        {
+            samples[ frame * NumSignals + signal ] = samplePosition( signal, frame );
+        }
+    }
+
+    // Current usage: one history vector and one filter per derivative per signal.
+    SavitzkyGolayFilter filters[ 3 ];
+    for( unsigned s = 0; s < 3; ++s )
+    {
+        SavitzkyGolayFilter::Options derivative = options;
+        derivative.s = s;
+        filters[ s ].configure( derivative );
+    }
+    std::vector<std::vector<ci::vec3>> histories( NumSignals );
+    std::vector<ci::vec3> perCall[ 3 ];
+    for( auto &outputs : perCall )
+    {
+        outputs.resize( NumSignals );
+    }
+
+    const auto perCallStart = std::chrono::steady_clock::now();
+    for( size_t frame = 0; frame < numFrames; ++frame )
+    {
+        for( size_t signal = 0; signal < NumSignals; ++signal )
+        {
+            std::vector<ci::vec3> &history = histories[ signal ];
+            history.push_back( samples[ frame * NumSignals + signal ] );
+            if( history.size() >= window )
+            {
+                for( size_t s = 0; s < 3; ++s )
+                {
+                    perCall[ s ][ signal ] = filters[ s ].filter( history );
+                }
+            }
+        }
+    }
+    const double perCallSeconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - perCallStart ).count();
+
+    SavitzkyGolayFilterBank bank( options );
+    const double bankSeconds = runBank( bank, samples, {}, numFrames );
+
+    // The same frames time stamped 1/30 s apart with a little jitter, then
+    // with one frame in 30 dropped.
+    std::vector<long long> uniformStamps( numFrames );
+    std::vector<long long> droppedStamps( numFrames );
+    std::vector<long long> droppedPeriods( numFrames );
+    long long dropped = 0;
+    for( size_t frame = 0; frame < numFrames; ++frame )
+    {
+        const long long jitter = static_cast<long long>( frame % 7 ) * 2000 - 6000;
+        dropped += frame % 30 == 29 ? 2 : 1;
+        uniformStamps[ frame ] = static_cast<long long>( frame ) * 333333 + jitter;
+        droppedStamps[ frame ] = dropped * 333333 + jitter;
+        droppedPeriods[ frame ] = dropped;
+    }
+    SavitzkyGolayFilterBank uniformBank( options );
+    const double uniformSeconds = runBank( uniformBank, samples, uniformStamps, numFrames );
+    SavitzkyGolayFilterBank droppedBank( options );
+    const double droppedSeconds = runBank( droppedBank, samples, droppedStamps, numFrames );
+
+    // Both see the same last window, so the last outputs must agree.
+    float difference = 0.0f;
+    for( size_t body = 0; body < NumBodies; ++body )
+    {
+        for( size_t joint = 0; joint < NumJoints; ++joint )
+        {
+            const size_t signal = body * NumJoints + joint;
+            difference = std::max( difference, maxDifference( bank.getPosition( body, joint ), perCall[ 0 ][ signal ] ) );
+            difference = std::max( difference, maxDifference( bank.getVelocity( body, joint ), perCall[ 1 ][ signal ] ) );
+            difference = std::max( difference, maxDifference( bank.getAcceleration( body, joint ), perCall[ 2 ][ signal ] ) );
+            difference = std::max( difference, maxDifference( uniformBank.getAcceleration( body, joint ), perCall[ 2 ][ signal ] ) );
+        }
+    }
+
+    // The dropped-frame output is checked against exact cubics instead:
+    // order 3 options, same window and time stamps.
+    SavitzkyGolayFilter::Options cubicOptions = options;
+    cubicOptions.n = 3;
+    const float droppedError = checkDroppedFrames( cubicOptions, droppedStamps, droppedPeriods );
+
+    const double frames = static_cast<double>( numFrames );
+    std::printf( "%zu frames, %zu signals, window %zu\n", numFrames, NumSignals, window );
+    std::printf( "per-call filter: %10.1f ns/frame\n", perCallSeconds * 1e9 / frames );
+    std::printf( "filter bank:     %10.1f ns/frame (%.1fx)\n", bankSeconds * 1e9 / frames,
+        bankSeconds > 0.0 ? perCallSeconds / bankSeconds : 0.0 );
+    std::printf( "time stamped:    %10.1f ns/frame\n", uniformSeconds * 1e9 / frames );
+    std::printf( "1/30 dropped:    %10.1f ns/frame (%zu patterns, %llu irregular frames)\n", droppedSeconds * 1e9 / frames,
+        droppedBank.getNumCachedPatterns(), static_cast<unsigned long long>( droppedBank.getNumIrregularPushes() ) );
+    std::printf( "max difference:  %g\n", difference );
+    std::printf( "dropped vs cubic: %g\n", droppedError );
+    // Acceleration at dt = 1/30 scales float rounding by 900.
+    return difference < 1e-2f && droppedError < 1e-2f ? EXIT_SUCCESS : EXIT_FAILURE;
+}
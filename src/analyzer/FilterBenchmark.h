@@ -0,0 +1,8 @@
+#pragma once
+
+#include <cstddef>
+
+//! Times SavitzkyGolayFilterBank against per-signal SavitzkyGolayFilter
+//! calls over growing history vectors, on synthetic motion for every joint
+//! of every body. Prints the results to stdout and returns an exit code.
+int runFilterBenchmark( size_t numFrames );
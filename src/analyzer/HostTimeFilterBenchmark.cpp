@@ -0,0 +1,84 @@
+#include "HostTimeFilterBenchmark.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <ableton/link/HostTimeFilter.hpp>
+
+namespace
+{
+
+// Frame period of the sensor, in host microseconds and in 100 ns ticks.
+constexpr std::int64_t FramePeriodMicros = 33333;
+constexpr double FramePeriodTicks = 333333.0;
+
+// Host times of every update, shared by both filters' clocks so they see
+// the same arrivals: a day into the host clock, with up to 3 ms of jitter.
+std::vector<std::int64_t> sHostTimes;
+
+struct ReplayClock
+{
+    size_t mIndex{ 0 };
+
+    std::chrono::microseconds micros()
+    {
+        return std::chrono::microseconds( sHostTimes[ mIndex++ % sHostTimes.size() ] );
+    }
+};
+
+double sampleTime( size_t update )
+{
+    return 1e6 + static_cast<double>( update ) * FramePeriodTicks;
+}
+
+template<typename Filter>
+double timeUpdates( size_t numUpdates, std::vector<std::int64_t> &hostTimes )
+{
+    Filter filter;
+    const auto start = std::chrono::steady_clock::now();
+    for( size_t update = 0; update < numUpdates; ++update )
+    {
+        hostTimes[ update ] = filter.sampleTimeToHostTime( sampleTime( update ) ).count();
+    }
+    const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / static_cast<double>( numUpdates );
+}
+
+} // namespace
+
+int runHostTimeFilterBenchmark( size_t numUpdates )
+{
+    if( numUpdates == 0 )
+    {
+        std::fprintf( stderr, "updates must be positive\n" );
+        return EXIT_FAILURE;
+    }
+
+    sHostTimes.resize( numUpdates );
+    for( size_t update = 0; update < numUpdates; ++update )
+    {
+        const std::int64_t jitter = static_cast<std::int64_t>( ( update * 7919 ) % 31 ) * 100 - 1500;
+        sHostTimes[ update ] = 86400000000LL + static_cast<std::int64_t>( update ) * FramePeriodMicros + jitter;
+    }
+
+    std::vector<std::int64_t> refitTimes( numUpdates );
+    std::vector<std::int64_t> incrementalTimes( numUpdates );
+    const double refit = timeUpdates<ableton::link::HostTimeFilter<ReplayClock>>( numUpdates, refitTimes );
+    const double incremental = timeUpdates<ableton::link::IncrementalHostTimeFilter<ReplayClock>>( numUpdates, incrementalTimes );
+
+    std::int64_t difference = 0;
+    for( size_t update = 0; update < numUpdates; ++update )
+    {
+        difference = std::max( difference, std::abs( refitTimes[ update ] - incrementalTimes[ update ] ) );
+    }
+
+    std::printf( "%zu updates, 512 points, 30 Hz sensor clock\n", numUpdates );
+    std::printf( "refit filter:        %8.1f ns/update\n", refit );
+    std::printf( "incremental filter:  %8.1f ns/update (%.1fx)\n", incremental, refit / incremental );
+    std::printf( "max difference:  %lld us\n", static_cast<long long>( difference ) );
+    // Both round the same fit to whole microseconds; the running sums may
+    // land on the other side of a rounding boundary.
+    return difference <= 1 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+#include <cstddef>
+
+//! Times Link's BasicIncrementalHostTimeFilter against BasicHostTimeFilter,
+//! which refits all of its points on every update, on the same jittered
+//! sensor clock, and checks that both map every sample to the same host
+//! time. Prints the results to stdout and returns an exit code.
+int runHostTimeFilterBenchmark( size_t numUpdates );
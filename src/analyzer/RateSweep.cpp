@@ -0,0 +1,181 @@
+#include "RateSweep.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "DanceDetector.h"
+
+namespace
+{
+
+constexpr double TicksPerSecond = 10000000.0;
+constexpr double Pi = 3.14159265358979323846;
+
+// Each foot is lifted in turn for half a second, first the left.
+constexpr double SlotDuration = 0.5;
+// The lift takes up the middle of the slot, so both feet rest in between.
+constexpr double LiftStart = 0.1;
+constexpr double LiftEnd = 0.9;
+constexpr double StepHeight = 0.1;
+// From this slot on, left lifts are knee raises.
+constexpr size_t FirstKneeSlot = 8;
+constexpr double KneeRaiseHeight = 0.25;
+constexpr size_t NumSlots = 16;
+
+constexpr float FloorY = -0.8f;
+constexpr float KneeY = -0.35f;
+constexpr float HipY = 0.1f;
+
+// Events must be matched this closely, in seconds.
+constexpr double MatchWindow = 0.1;
+// Pass when every onset of every rate is this close to the analytic one.
+constexpr double MaxStepError = 0.005;
+constexpr double MaxKneeError = 0.05;
+
+struct Truth
+{
+    DanceEvent::Type type;
+    double seconds;
+};
+
+bool isKneeSlot( size_t slot )
+{
+    return slot >= FirstKneeSlot && slot % 2 == 0;
+}
+
+double liftHeight( size_t slot )
+{
+    return isKneeSlot( slot ) ? KneeRaiseHeight : StepHeight;
+}
+
+// Height of a foot above the floor, and of its knee for a knee raise.
+void lift( size_t side, double seconds, double &footLift, double &kneeLift )
+{
+    footLift = 0.0;
+    kneeLift = 0.0;
+    const size_t slot = static_cast<size_t>( seconds / SlotDuration );
+    if( slot >= NumSlots || slot % 2 != side )
+    {
+        return;
+    }
+    const double phase = seconds / SlotDuration - static_cast<double>( slot );
+    if( phase < LiftStart || phase > LiftEnd )
+    {
+        return;
+    }
+    const double height = liftHeight( slot ) * std::sin( Pi * ( phase - LiftStart ) / ( LiftEnd - LiftStart ) );
+    footLift = height;
+    kneeLift = isKneeSlot( slot ) ? height : 0.0;
+}
+
+std::vector<Truth> makeTruth()
+{
+    std::vector<Truth> truth;
+    const double liftSeconds = SlotDuration * ( LiftEnd - LiftStart );
+    for( size_t slot = 0; slot < NumSlots; ++slot )
+    {
+        const double start = slot * SlotDuration + LiftStart * SlotDuration;
+        const double height = liftHeight( slot );
+        if( isKneeSlot( slot ) )
+        {
+            // The knee rises slower than the apex speed from here on.
+            const double peakSpeed = height * Pi / liftSeconds;
+            const double u = std::acos( DanceDetector::KneeApexSpeed / peakSpeed ) / Pi;
+            truth.push_back( { DanceEvent::Type::KneeRaise, start + u * liftSeconds } );
+        }
+        // The foot passes back down through the step threshold.
+        const double u = 1.0 - std::asin( DanceDetector::FootDownThresh / height ) / Pi;
+        truth.push_back( { DanceEvent::Type::FootStep, start + u * liftSeconds } );
+    }
+    return truth;
+}
+
+Kinect2::BodyFrame makeFrame( double seconds )
+{
+    Kinect2::Body body( 1, 0 );
+    body.setJoint( JointType_SpineBase, ci::vec3( 0.0f, HipY, 2.0f ) );
+    for( size_t side = 0; side < 2; ++side )
+    {
+        double footLift = 0.0;
+        double kneeLift = 0.0;
+        lift( side, seconds, footLift, kneeLift );
+        const float x = side == 0 ? -0.1f : 0.1f;
+        body.setJoint( side == 0 ? JointType_HipLeft : JointType_HipRight, ci::vec3( x, HipY, 2.0f ) );
+        body.setJoint( side == 0 ? JointType_KneeLeft : JointType_KneeRight, ci::vec3( x, KneeY + static_cast<float>( kneeLift ), 2.0f ) );
+        body.setJoint( side == 0 ? JointType_AnkleLeft : JointType_AnkleRight, ci::vec3( x, FloorY + 0.05f + static_cast<float>( footLift ), 2.0f ) );
+        body.setJoint( side == 0 ? JointType_FootLeft : JointType_FootRight, ci::vec3( x, FloorY + static_cast<float>( footLift ), 2.1f ) );
+    }
+    // Arbitrary sensor epoch.
+    const long long timeStamp = 50000000LL + std::llround( seconds * TicksPerSecond );
+    return Kinect2::BodyFrame( timeStamp, { body } );
+}
+
+} // namespace
+
+int runRateSweep()
+{
+    const std::vector<Truth> truth = makeTruth();
+    const double rates[] = { 30.0, 60.0, 120.0, 240.0 };
+    const double duration = NumSlots * SlotDuration + 0.5;
+    bool passed = true;
+
+    std::printf( "%zu steps and knee raises over %.1f s\n", truth.size(), duration );
+    std::printf( " rate   steps  knees  step err mean/max (ms)  knee err mean/max (ms)\n" );
+    for( double rate : rates )
+    {
+        DanceDetector detector;
+        std::vector<DanceEvent> events;
+        const size_t numFrames = static_cast<size_t>( duration * rate );
+        for( size_t frame = 0; frame < numFrames; ++frame )
+        {
+            const Kinect2::BodyFrame bodyFrame = makeFrame( static_cast<double>( frame ) / rate );
+            detector.process( bodyFrame, events );
+        }
+
+        size_t numMatched[ 2 ] = { 0, 0 };
+        size_t numEvents[ 2 ] = { 0, 0 };
+        size_t numExpected[ 2 ] = { 0, 0 };
+        double sumError[ 2 ] = { 0.0, 0.0 };
+        double maxError[ 2 ] = { 0.0, 0.0 };
+        for( const DanceEvent &event : events )
+        {
+            ++numEvents[ static_cast<size_t>( event.type ) ];
+        }
+        for( const Truth &expected : truth )
+        {
+            const size_t type = static_cast<size_t>( expected.type );
+            ++numExpected[ type ];
+            double best = MatchWindow;
+            for( const DanceEvent &event : events )
+            {
+                const double seconds = ( event.timeStamp - 50000000LL ) / TicksPerSecond;
+                if( event.type == expected.type && std::abs( seconds - expected.seconds ) < std::abs( best ) )
+                {
+                    best = seconds - expected.seconds;
+                }
+            }
+            if( std::abs( best ) < MatchWindow )
+            {
+                ++numMatched[ type ];
+                sumError[ type ] += std::abs( best );
+                maxError[ type ] = std::max( maxError[ type ], std::abs( best ) );
+            }
+        }
+
+        const size_t step = static_cast<size_t>( DanceEvent::Type::FootStep );
+        const size_t knee = static_cast<size_t>( DanceEvent::Type::KneeRaise );
+        std::printf( "%4.0f Hz  %2zu/%zu  %2zu/%zu  %9.2f / %-9.2f  %9.2f / %-9.2f\n", rate,
+            numEvents[ step ], numExpected[ step ], numEvents[ knee ], numExpected[ knee ],
+            numMatched[ step ] ? 1000.0 * sumError[ step ] / numMatched[ step ] : 0.0, 1000.0 * maxError[ step ],
+            numMatched[ knee ] ? 1000.0 * sumError[ knee ] / numMatched[ knee ] : 0.0, 1000.0 * maxError[ knee ] );
+
+        for( size_t type : { step, knee } )
+        {
+            passed = passed && numEvents[ type ] == numExpected[ type ] && numMatched[ type ] == numExpected[ type ];
+        }
+        passed = passed && maxError[ step ] <= MaxStepError && maxError[ knee ] <= MaxKneeError;
+    }
+    std::printf( "%s\n", passed ? "passed" : "FAILED" );
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+//! Replays the same synthetic dance, alternating steps with knee raises, at
+//! 30, 60, 120 and 240 Hz through DanceDetector and checks every rate finds
+//! the same events at the same times. Prints the results to stdout and
+//! returns an exit code.
+int runRateSweep();
@@ -0,0 +1,138 @@
+#include "SchedulerTest.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <LinkScheduler.h>
+#include <LinkWrapper.h>
+
+namespace
+{
+
+constexpr double Tempo = 120.0;
+constexpr double ClockRate = 4.0;
+constexpr std::chrono::milliseconds RunTime{ 2000 };
+constexpr std::chrono::milliseconds FrozenTime{ 500 };
+constexpr double MaxFrozenLoad = 0.25;
+constexpr std::chrono::milliseconds MaxStopTime{ 200 };
+
+struct Recorder
+{
+    std::mutex mutex;
+    std::vector<LinkScheduler::Event> events;
+
+    void add( const LinkScheduler::Event &event )
+    {
+        std::lock_guard<std::mutex> lock( mutex );
+        events.push_back( event );
+    }
+
+    std::vector<LinkScheduler::Event> take()
+    {
+        std::lock_guard<std::mutex> lock( mutex );
+        return std::move( events );
+    }
+};
+
+LinkWrapper::Snapshot makeTimeline()
+{
+    LinkWrapper::Snapshot timeline;
+    timeline.tempo = Tempo;
+    timeline.isPlaying = true;
+    return timeline;
+}
+
+bool testRunningClock()
+{
+    // Host time runs ClockRate times faster than real time from zero.
+    const auto origin = std::chrono::steady_clock::now();
+    LinkWrapper link;
+    link.setClock( [origin]
+    {
+        const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>( std::chrono::steady_clock::now() - origin );
+        return std::chrono::microseconds( static_cast<long long>( elapsed.count() * ClockRate ) );
+    } );
+    link.setTimeline( makeTimeline() );
+
+    Recorder recorder;
+    LinkScheduler scheduler( link );
+    scheduler.addHandler( 1.0, 0.0, [&recorder]( const LinkScheduler::Event &event ) { recorder.add( event ); } );
+    scheduler.start();
+    std::this_thread::sleep_for( RunTime );
+    scheduler.stop();
+
+    const std::vector<LinkScheduler::Event> events = recorder.take();
+    const double expected = std::chrono::duration<double>( RunTime ).count() * ClockRate * Tempo / 60.0;
+    bool passed = std::abs( static_cast<double>( events.size() ) - expected ) <= 2.0;
+    // Lateness is OS wake-up jitter, so it is reported, not checked; it is
+    // converted back to real time from the faster host clock.
+    double totalLateness = 0.0;
+    double maxLateness = 0.0;
+    for( size_t i = 0; i < events.size(); ++i )
+    {
+        passed &= i == 0 || events[ i ].beat == events[ i - 1 ].beat + 1.0;
+        passed &= events[ i ].hostTime == link.timeAtBeat( events[ i ].beat );
+        const double lateness = static_cast<double>( ( events[ i ].firedTime - events[ i ].hostTime ).count() ) / ClockRate;
+        totalLateness += lateness;
+        maxLateness = std::max( maxLateness, lateness );
+    }
+    std::printf( "%.0fx clock:  %zu beats (%.0f expected), lateness %.2f ms mean, %.2f ms max\n",
+        ClockRate, events.size(), expected,
+        events.empty() ? 0.0 : totalLateness / static_cast<double>( events.size() ) / 1000.0, maxLateness / 1000.0 );
+    return passed;
+}
+
+bool testFrozenClock()
+{
+    // Frozen 1 ms before beat 4, as when a replay pauses or ends.
+    const LinkWrapper::Snapshot timeline = makeTimeline();
+    std::atomic<long long> hostTime{ timeline.timeAtBeat( 4.0 ).count() - 1000 };
+    LinkWrapper link;
+    link.setClock( [&hostTime] { return std::chrono::microseconds( hostTime.load() ); } );
+    link.setTimeline( timeline );
+
+    Recorder recorder;
+    LinkScheduler scheduler( link );
+    scheduler.addHandler( 1.0, 0.0, [&recorder]( const LinkScheduler::Event &event ) { recorder.add( event ); } );
+    const std::clock_t cpuStart = std::clock();
+    scheduler.start();
+    std::this_thread::sleep_for( FrozenTime );
+    const double load = static_cast<double>( std::clock() - cpuStart ) / CLOCKS_PER_SEC / std::chrono::duration<double>( FrozenTime ).count();
+    const size_t numFrozenEvents = recorder.take().size();
+
+    // Released, the beat is still fired.
+    hostTime += 2000;
+    std::this_thread::sleep_for( std::chrono::milliseconds( 100 ) );
+    const std::vector<LinkScheduler::Event> released = recorder.take();
+
+    // Stopped while frozen short of the next beat.
+    hostTime = timeline.timeAtBeat( 5.0 ).count() - 1000;
+    std::this_thread::sleep_for( std::chrono::milliseconds( 50 ) );
+    const auto stopStart = std::chrono::steady_clock::now();
+    scheduler.stop();
+    const auto stopTime = std::chrono::steady_clock::now() - stopStart;
+
+    const bool passed = numFrozenEvents == 0 && load <= MaxFrozenLoad
+        && released.size() == 1 && released.front().beat == 4.0
+        && stopTime <= MaxStopTime;
+    std::printf( "frozen clock: %zu beats while frozen, %.0f%% CPU, %zu beat when released, stop in %.2f ms\n",
+        numFrozenEvents, load * 100.0, released.size(),
+        std::chrono::duration<double, std::milli>( stopTime ).count() );
+    return passed;
+}
+
+} // namespace
+
+int runSchedulerTest()
+{
+    bool passed = testRunningClock();
+    passed &= testFrozenClock();
+    std::printf( "%s\n", passed ? "passed" : "FAILED" );
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,8 @@
+#pragma once
+
+//! Runs LinkScheduler on an injected clock: one running at four times real
+//! time, which must fire every beat in order at its exact host time (how
+//! late each fires is reported, not checked), and one frozen just short of
+//! a beat, which must fire nothing, stay off the CPU and stop promptly.
+//! Prints the results to stdout and returns an exit code.
+int runSchedulerTest();
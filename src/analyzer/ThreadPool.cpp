@@ -0,0 +1,143 @@
+#include "ThreadPool.h"
+#include <algorithm>
+
+// Pool and worker index of the worker running on this thread, if any.
+static thread_local const ThreadPool *sPool = nullptr;
+static thread_local size_t sWorkerIndex = 0;
+
+ThreadPool::ThreadPool( size_t numThreads )
+{
+    numThreads = std::max<size_t>( numThreads, 1 );
+    mWorkers.reserve( numThreads );
+    for( size_t i = 0; i < numThreads; ++i )
+    {
+        mWorkers.push_back( std::make_unique<Worker>() );
+    }
+    mThreads.reserve( numThreads );
+    for( size_t i = 0; i < numThreads; ++i )
+    {
+        mThreads.emplace_back( &ThreadPool::run, this, i );
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock( mMutex );
+        mRunning = false;
+    }
+    mCondition.notify_all();
+    for( auto &thread : mThreads )
+    {
+        thread.join();
+    }
+}
+
+void ThreadPool::submit( Task task )
+{
+    size_t index = 0;
+    if( sPool == this )
+    {
+        index = sWorkerIndex;
+    }
+    else
+    {
+        std::lock_guard<std::mutex> lock( mMutex );
+        index = mNextWorker;
+        mNextWorker = ( mNextWorker + 1 ) % mWorkers.size();
+    }
+
+    mNumPending.fetch_add( 1, std::memory_order_relaxed );
+    {
+        // Counted under mMutex, and before the task can be taken, so a
+        // worker about to sleep cannot miss it.
+        std::lock_guard<std::mutex> lock( mMutex );
+        mNumQueued.fetch_add( 1, std::memory_order_relaxed );
+    }
+    {
+        std::lock_guard<std::mutex> lock( mWorkers[ index ]->mutex );
+        mWorkers[ index ]->tasks.push_back( std::move( task ) );
+    }
+    mCondition.notify_one();
+}
+
+void ThreadPool::wait()
+{
+    std::unique_lock<std::mutex> lock( mMutex );
+    mDoneCondition.wait( lock, [this] { return mNumPending.load( std::memory_order_acquire ) == 0; } );
+    if( mException )
+    {
+        std::exception_ptr exception = mException;
+        mException = nullptr;
+        std::rethrow_exception( exception );
+    }
+}
+
+bool ThreadPool::pop( size_t index, Task &task )
+{
+    Worker &worker = *mWorkers[ index ];
+    std::lock_guard<std::mutex> lock( worker.mutex );
+    if( worker.tasks.empty() )
+    {
+        return false;
+    }
+    task = std::move( worker.tasks.back() );
+    worker.tasks.pop_back();
+    return true;
+}
+
+bool ThreadPool::steal( size_t index, Task &task )
+{
+    for( size_t i = 1; i < mWorkers.size(); ++i )
+    {
+        Worker &victim = *mWorkers[ ( index + i ) % mWorkers.size() ];
+        std::lock_guard<std::mutex> lock( victim.mutex );
+        if( !victim.tasks.empty() )
+        {
+            task = std::move( victim.tasks.front() );
+            victim.tasks.pop_front();
+            mNumSteals.fetch_add( 1, std::memory_order_relaxed );
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::run( size_t index )
+{
+    sPool = this;
+    sWorkerIndex = index;
+    while( true )
+    {
+        Task task;
+        if( pop( index, task ) || steal( index, task ) )
+        {
+            mNumQueued.fetch_sub( 1, std::memory_order_relaxed );
+            try
+            {
+                task();
+            }
+            catch( ... )
+            {
+                std::lock_guard<std::mutex> lock( mMutex );
+                if( !mException )
+                {
+                    mException = std::current_exception();
+                }
+            }
+            if( mNumPending.fetch_sub( 1, std::memory_order_acq_rel ) == 1 )
+            {
+                std::lock_guard<std::mutex> lock( mMutex );
+                mDoneCondition.notify_all();
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock( mMutex );
+        mCondition.wait( lock, [this] { return !mRunning || mNumQueued.load( std::memory_order_relaxed ) > 0; } );
+        if( !mRunning )
+        {
+            break;
+        }
+    }
+}
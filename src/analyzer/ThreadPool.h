@@ -0,0 +1,65 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//! Fixed set of worker threads, each with its own task deque. A worker runs
+//! its own tasks newest first and, when it runs dry, steals the oldest task
+//! from another worker, so uneven tasks (long and short recordings) still
+//! keep every core busy.
+class ThreadPool
+{
+public:
+    using Task = std::function<void()>;
+
+    explicit ThreadPool( size_t numThreads = std::thread::hardware_concurrency() );
+    ~ThreadPool();
+
+    ThreadPool( const ThreadPool & ) = delete;
+    ThreadPool &operator=( const ThreadPool & ) = delete;
+
+    //! Queues \a task. Called from a worker, the task goes to that worker's
+    //! own deque; otherwise the deques are filled round robin.
+    void submit( Task task );
+    //! Blocks until every submitted task has finished. Rethrows the first
+    //! exception a task threw.
+    void wait();
+
+    size_t getNumThreads() const;
+    size_t getNumSteals() const;
+
+private:
+    struct Worker
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void run( size_t index );
+    bool pop( size_t index, Task &task );
+    bool steal( size_t index, Task &task );
+
+    std::vector<std::unique_ptr<Worker>> mWorkers;
+    std::vector<std::thread> mThreads;
+
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+    std::condition_variable mDoneCondition;
+    std::exception_ptr mException;
+    bool mRunning{ true };
+    size_t mNextWorker{ 0 };
+
+    std::atomic<size_t> mNumQueued{ 0 };
+    std::atomic<size_t> mNumPending{ 0 };
+    std::atomic<size_t> mNumSteals{ 0 };
+};
+
+inline size_t ThreadPool::getNumThreads() const { return mThreads.size(); }
+inline size_t ThreadPool::getNumSteals() const { return mNumSteals.load( std::memory_order_relaxed ); }